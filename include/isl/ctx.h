@@ -69,9 +69,6 @@ extern "C" {
  * (in case of pointer return type).
  * The only exception is the isl_ctx argument, which should never be NULL.
  */
-struct isl_stats {
-	long	gbr_solved_lps;
-};
 enum isl_error {
 	isl_error_none = 0,
 	isl_error_abort,
@@ -169,6 +166,14 @@ void isl_ctx_ref(struct isl_ctx *ctx);
 void isl_ctx_deref(struct isl_ctx *ctx);
 void isl_ctx_free(isl_ctx *ctx);
 
+isl_stat isl_ctx_freeze(isl_ctx *ctx);
+isl_bool isl_ctx_is_frozen(isl_ctx *ctx);
+isl_ctx *isl_ctx_alloc_child(isl_ctx *parent);
+isl_ctx *isl_ctx_get_parent(isl_ctx *ctx);
+
+isl_stat isl_ctx_push_block_retention(isl_ctx *ctx);
+isl_stat isl_ctx_pop_block_retention(isl_ctx *ctx);
+
 void isl_ctx_abort(isl_ctx *ctx);
 void isl_ctx_resume(isl_ctx *ctx);
 int isl_ctx_aborted(isl_ctx *ctx);
@@ -177,6 +182,47 @@ void isl_ctx_set_max_operations(isl_ctx *ctx, unsigned long max_operations);
 unsigned long isl_ctx_get_max_operations(isl_ctx *ctx);
 void isl_ctx_reset_operations(isl_ctx *ctx);
 
+enum isl_ctx_stat {
+	isl_ctx_stat_gbr_solved_lps,
+	isl_ctx_stat_blk_alloc,
+	isl_ctx_stat_blk_cache_hit,
+	isl_ctx_stat_blk_malloc,
+	isl_ctx_stat_space_interned,
+	isl_ctx_stat_basic_map_cache_hit,
+	isl_ctx_stat_basic_map_cache_miss,
+	isl_ctx_stat_subtract_pairs,
+	isl_ctx_stat_subtract_pruned_pairs,
+	isl_ctx_stat_tab_alloc,
+	isl_ctx_stat_tab_pivots,
+	isl_ctx_stat_tab_float_guided,
+	isl_ctx_stat_pip_splits,
+	isl_ctx_stat_pip_max_level,
+	isl_ctx_stat_coalesce_pairs,
+	isl_ctx_stat_coalesce_clock,
+	isl_ctx_stat_farkas,
+	isl_ctx_stat_farkas_clock,
+	isl_ctx_stat_sched_lp,
+	isl_ctx_stat_sched_lp_clock,
+	isl_ctx_stat_sched_fallback,
+	isl_ctx_stat_ast_build,
+	isl_ctx_stat_ast_build_clock
+};
+
+long isl_ctx_get_stat(isl_ctx *ctx, enum isl_ctx_stat stat);
+void isl_ctx_reset_stats(isl_ctx *ctx);
+__isl_give char *isl_ctx_stats_to_json(isl_ctx *ctx);
+
+enum isl_trace_event {
+	isl_trace_begin,
+	isl_trace_end
+};
+
+isl_stat isl_ctx_set_trace_callback(isl_ctx *ctx,
+	void (*fn)(isl_ctx *ctx, enum isl_trace_event event,
+		const char *name, int size, void *user),
+	void *user, void (*free_user)(void *user));
+isl_stat isl_ctx_trace_to_chrome_file(isl_ctx *ctx, FILE *out);
+
 #define ISL_ARG_CTX_DECL(prefix,st,args)				\
 st *isl_ctx_peek_ ## prefix(isl_ctx *ctx);
 
@@ -11,6 +11,7 @@
 #define ISL_LP_H
 
 #include <isl/aff.h>
+#include <isl/constraint.h>
 #include <isl/val_type.h>
 #include <isl/set_type.h>
 
@@ -30,6 +31,25 @@ __isl_give isl_val *isl_basic_set_min_lp_val(__isl_keep isl_basic_set *bset,
 __isl_give isl_val *isl_basic_set_max_lp_val(__isl_keep isl_basic_set *bset,
 	__isl_keep isl_aff *obj);
 
+struct isl_lp_solver;
+typedef struct isl_lp_solver isl_lp_solver;
+
+__isl_give isl_lp_solver *isl_lp_solver_from_basic_set(
+	__isl_take isl_basic_set *bset);
+__isl_null isl_lp_solver *isl_lp_solver_free(
+	__isl_take isl_lp_solver *solver);
+isl_ctx *isl_lp_solver_get_ctx(__isl_keep isl_lp_solver *solver);
+
+__isl_give isl_val *isl_lp_solver_min_val(__isl_keep isl_lp_solver *solver,
+	__isl_keep isl_aff *obj);
+__isl_give isl_val *isl_lp_solver_max_val(__isl_keep isl_lp_solver *solver,
+	__isl_keep isl_aff *obj);
+
+__isl_give isl_lp_solver *isl_lp_solver_add_constraint(
+	__isl_take isl_lp_solver *solver, __isl_take isl_constraint *c);
+__isl_give isl_lp_solver *isl_lp_solver_drop_last_constraint(
+	__isl_take isl_lp_solver *solver);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -49,6 +49,21 @@ int isl_options_get_coalesce_bounded_wrapping(isl_ctx *ctx);
 isl_stat isl_options_set_coalesce_preserve_locals(isl_ctx *ctx, int val);
 int isl_options_get_coalesce_preserve_locals(isl_ctx *ctx);
 
+isl_stat isl_options_set_intern_spaces(isl_ctx *ctx, int val);
+int isl_options_get_intern_spaces(isl_ctx *ctx);
+
+isl_stat isl_options_set_basic_map_cache_size(isl_ctx *ctx, int val);
+int isl_options_get_basic_map_cache_size(isl_ctx *ctx);
+
+isl_stat isl_options_set_tab_float_guide(isl_ctx *ctx, int val);
+int isl_options_get_tab_float_guide(isl_ctx *ctx);
+
+isl_stat isl_options_set_intersect_drop_redundant(isl_ctx *ctx, int val);
+int isl_options_get_intersect_drop_redundant(isl_ctx *ctx);
+
+isl_stat isl_options_set_stats_clock(isl_ctx *ctx, int val);
+int isl_options_get_stats_clock(isl_ctx *ctx);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -50,6 +50,15 @@ int isl_options_get_schedule_whole_component(isl_ctx *ctx);
 isl_stat isl_options_set_schedule_carry_self_first(isl_ctx *ctx, int val);
 int isl_options_get_schedule_carry_self_first(isl_ctx *ctx);
 
+isl_stat isl_options_set_schedule_cache_slots(isl_ctx *ctx, int val);
+int isl_options_get_schedule_cache_slots(isl_ctx *ctx);
+
+isl_stat isl_options_set_schedule_cache_max_entry_size(isl_ctx *ctx, int val);
+int isl_options_get_schedule_cache_max_entry_size(isl_ctx *ctx);
+
+isl_stat isl_options_set_schedule_max_operations(isl_ctx *ctx, int val);
+int isl_options_get_schedule_max_operations(isl_ctx *ctx);
+
 __isl_give isl_schedule_constraints *isl_schedule_constraints_copy(
 	__isl_keep isl_schedule_constraints *sc);
 __isl_export
@@ -122,6 +131,13 @@ __isl_give char *isl_schedule_constraints_to_str(
 __isl_export
 __isl_give isl_schedule *isl_schedule_constraints_compute_schedule(
 	__isl_take isl_schedule_constraints *sc);
+__isl_give isl_schedule *isl_schedule_constraints_update_schedule(
+	__isl_take isl_schedule_constraints *sc,
+	__isl_take isl_schedule *schedule);
+__isl_give char *isl_schedule_constraints_get_cache_key(
+	__isl_keep isl_schedule_constraints *sc);
+__isl_give isl_schedule *isl_schedule_constraints_compute_schedule_cached(
+	__isl_take isl_schedule_constraints *sc, const char *dir);
 
 __isl_give isl_schedule *isl_union_set_compute_schedule(
 	__isl_take isl_union_set *domain,
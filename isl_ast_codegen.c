@@ -11,6 +11,8 @@
  */
 
 #include <limits.h>
+#include <time.h>
+#include <isl_ctx_private.h>
 #include <isl/id.h>
 #include <isl/val.h>
 #include <isl/space.h>
@@ -5122,15 +5124,27 @@ error:
 __isl_give isl_ast_node *isl_ast_build_node_from_schedule_map(
 	__isl_keep isl_ast_build *build, __isl_take isl_union_map *schedule)
 {
+	isl_ctx *ctx;
 	isl_ast_graft_list *list;
 	isl_ast_node *node;
 	isl_union_map *executed;
+	isl_size n;
+	clock_t start;
 
+	ctx = isl_union_map_get_ctx(schedule);
+	if (!ctx)
+		return NULL;
+	ctx->stats->ast_build++;
+	start = isl_ctx_clock(ctx);
+	n = isl_union_map_n_map(schedule);
+	isl_ctx_trace_begin(ctx, "isl_ast_build_node_from_schedule_map", n);
 	schedule = isl_union_map_coalesce(schedule);
 	schedule = isl_union_map_remove_redundancies(schedule);
 	executed = isl_union_map_reverse(schedule);
 	list = generate_code(executed, isl_ast_build_copy(build), 0);
 	node = isl_ast_node_from_graft_list(list, build);
+	isl_ctx_trace_end(ctx, "isl_ast_build_node_from_schedule_map", n);
+	ctx->stats->ast_build_clock += isl_ctx_clock(ctx) - start;
 
 	return node;
 }
@@ -5887,23 +5901,36 @@ __isl_give isl_ast_node *isl_ast_build_node_from_schedule(
 {
 	isl_ctx *ctx;
 	isl_schedule_node *node;
+	isl_ast_node *tree;
+	isl_union_set *domain;
+	isl_size n;
+	clock_t start;
 
 	if (!build || !schedule)
 		goto error;
 
 	ctx = isl_ast_build_get_ctx(build);
+	ctx->stats->ast_build++;
+	start = isl_ctx_clock(ctx);
 
 	node = isl_schedule_get_root(schedule);
 	if (!node)
 		goto error;
+	domain = isl_schedule_get_domain(schedule);
+	n = isl_union_set_n_set(domain);
+	isl_union_set_free(domain);
 	isl_schedule_free(schedule);
+	isl_ctx_trace_begin(ctx, "isl_ast_build_node_from_schedule", n);
 
 	build = isl_ast_build_copy(build);
 	if (isl_schedule_node_get_type(node) != isl_schedule_node_domain)
 		isl_die(ctx, isl_error_unsupported,
 			"expecting root domain node",
 			build = isl_ast_build_free(build));
-	return build_ast_from_domain(build, node);
+	tree = build_ast_from_domain(build, node);
+	isl_ctx_trace_end(ctx, "isl_ast_build_node_from_schedule", n);
+	ctx->stats->ast_build_clock += isl_ctx_clock(ctx) - start;
+	return tree;
 error:
 	isl_schedule_free(schedule);
 	return NULL;
@@ -0,0 +1,477 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_space_private.h>
+#include <isl_options_private.h>
+#include <isl_seq.h>
+#include <isl_basic_map_cache.h>
+
+/* An entry in the cache of results of operations on basic maps.
+ *
+ * "key" is a copy of the input of operation "op", taken before
+ * the operation was applied, and "hash" is its hash value.
+ * For an operation that tests a property, "verdict" is the outcome.
+ * For an operation that transforms the basic map, "res" is the result,
+ * or NULL if the operation left the input unchanged.
+ * "size" is an estimate of the number of bytes used by this entry.
+ * "prev" and "next" link the entries in order of most recent use.
+ */
+struct isl_basic_map_cache_entry {
+	uint32_t hash;
+	enum isl_basic_map_cache_op op;
+	isl_basic_map *key;
+	isl_basic_map *res;
+	isl_bool verdict;
+	size_t size;
+
+	struct isl_basic_map_cache_entry *prev;
+	struct isl_basic_map_cache_entry *next;
+};
+
+/* A cache of results of operations on basic maps.
+ *
+ * "table" maps the inputs to the corresponding entries.
+ * "first" is the most recently used entry and "last" the least recently
+ * used entry.
+ * "size" is the total estimated size of all entries in bytes.
+ */
+struct isl_basic_map_cache {
+	struct isl_hash_table table;
+
+	struct isl_basic_map_cache_entry *first;
+	struct isl_basic_map_cache_entry *last;
+
+	size_t size;
+};
+
+/* The input to a cache lookup.
+ */
+struct isl_basic_map_cache_key {
+	enum isl_basic_map_cache_op op;
+	isl_basic_map *bmap;
+};
+
+static void evict(isl_ctx *ctx, struct isl_basic_map_cache *cache);
+
+/* Return the cache of "ctx" if caching is enabled, allocating it
+ * if needed, or NULL if caching is disabled.
+ *
+ * A frozen context is never modified, so nothing is cached
+ * in such a context.
+ * The basic_map_cache_size option may have been reduced
+ * since entries were last added to the cache, so first evict
+ * the least recently used entries until the cache fits
+ * within the current limit.  If caching has been disabled,
+ * then the entire cache is freed.
+ */
+static struct isl_basic_map_cache *get_cache(isl_ctx *ctx)
+{
+	struct isl_basic_map_cache *cache;
+	int limit = ctx->opt->basic_map_cache_size;
+
+	if (ctx->frozen)
+		return NULL;
+	if (limit <= 0) {
+		isl_basic_map_cache_free(ctx);
+		return NULL;
+	}
+	if (ctx->bmap_cache) {
+		cache = ctx->bmap_cache;
+		while (cache->last && cache->size > (size_t) limit)
+			evict(ctx, cache);
+		return cache;
+	}
+
+	cache = isl_calloc_type(ctx, struct isl_basic_map_cache);
+	if (!cache)
+		return NULL;
+	if (isl_hash_table_init(ctx, &cache->table, 0) < 0) {
+		free(cache);
+		return NULL;
+	}
+	ctx->bmap_cache = cache;
+	return cache;
+}
+
+/* Compute a hash value for operation "op" applied to "bmap".
+ *
+ * Since cache entries are only reused for inputs that have
+ * exactly the same representation, the constraints are hashed
+ * in the order in which they appear.
+ */
+static uint32_t basic_map_cache_hash(__isl_keep isl_basic_map *bmap,
+	enum isl_basic_map_cache_op op, isl_size total)
+{
+	int i;
+	uint32_t hash = isl_hash_init();
+
+	isl_hash_byte(hash, op & 0xFF);
+	isl_hash_hash(hash, isl_space_get_full_hash(bmap->dim));
+	isl_hash_builtin(hash, bmap->flags);
+	isl_hash_byte(hash, bmap->n_eq & 0xFF);
+	for (i = 0; i < bmap->n_eq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bmap->eq[i], 1 + total));
+	isl_hash_byte(hash, bmap->n_ineq & 0xFF);
+	for (i = 0; i < bmap->n_ineq; ++i)
+		isl_hash_hash(hash, isl_seq_get_hash(bmap->ineq[i], 1 + total));
+	isl_hash_byte(hash, bmap->n_div & 0xFF);
+	for (i = 0; i < bmap->n_div; ++i)
+		isl_hash_hash(hash,
+			    isl_seq_get_hash(bmap->div[i], 1 + 1 + total));
+
+	return hash;
+}
+
+/* Do "bmap1" and "bmap2" have exactly the same representation,
+ * including the identifiers of all dimensions and all flags?
+ */
+static isl_bool basic_map_is_identical(__isl_keep isl_basic_map *bmap1,
+	__isl_keep isl_basic_map *bmap2)
+{
+	isl_bool equal;
+
+	if (bmap1->flags != bmap2->flags)
+		return isl_bool_false;
+	if (isl_basic_map_plain_cmp(bmap1, bmap2) != 0)
+		return isl_bool_false;
+	equal = isl_space_is_equal(bmap1->dim, bmap2->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	return isl_space_has_equal_ids(bmap1->dim, bmap2->dim);
+}
+
+/* Is the cache entry "entry" an entry for the input "val"?
+ */
+static isl_bool has_key(const void *entry, const void *val)
+{
+	const struct isl_basic_map_cache_entry *cache_entry = entry;
+	const struct isl_basic_map_cache_key *key = val;
+
+	if (cache_entry->op != key->op)
+		return isl_bool_false;
+	return basic_map_is_identical(cache_entry->key, key->bmap);
+}
+
+/* Is "entry" the cache entry "val"?
+ */
+static isl_bool is_entry(const void *entry, const void *val)
+{
+	return isl_bool_ok(entry == val);
+}
+
+/* Return an estimate of the number of bytes used by "bmap".
+ */
+static size_t basic_map_size(__isl_keep isl_basic_map *bmap)
+{
+	if (!bmap)
+		return 0;
+	return sizeof(*bmap) +
+	    (bmap->block.size + bmap->block2.size) * sizeof(isl_int) +
+	    (bmap->c_size + bmap->extra) * sizeof(isl_int *);
+}
+
+/* Remove "entry" from the list of entries of "cache".
+ */
+static void unlink_entry(struct isl_basic_map_cache *cache,
+	struct isl_basic_map_cache_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->first = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->last = entry->prev;
+	entry->prev = entry->next = NULL;
+}
+
+/* Add "entry" to the front of the list of entries of "cache",
+ * marking it as the most recently used entry.
+ */
+static void link_entry(struct isl_basic_map_cache *cache,
+	struct isl_basic_map_cache_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = cache->first;
+	if (cache->first)
+		cache->first->prev = entry;
+	else
+		cache->last = entry;
+	cache->first = entry;
+}
+
+/* Free "entry" and the basic maps it holds.
+ */
+static void free_entry(struct isl_basic_map_cache_entry *entry)
+{
+	isl_basic_map_free(entry->key);
+	isl_basic_map_free(entry->res);
+	free(entry);
+}
+
+/* Remove the least recently used entry from "cache".
+ */
+static void evict(isl_ctx *ctx, struct isl_basic_map_cache *cache)
+{
+	struct isl_basic_map_cache_entry *entry = cache->last;
+	struct isl_hash_table_entry *table_entry;
+
+	unlink_entry(cache, entry);
+	table_entry = isl_hash_table_find(ctx, &cache->table, entry->hash,
+					&is_entry, entry, 0);
+	if (table_entry && table_entry != isl_hash_table_entry_none)
+		isl_hash_table_remove(ctx, &cache->table, table_entry);
+	cache->size -= entry->size;
+	free_entry(entry);
+}
+
+/* Look for an entry for operation "op" applied to "bmap" with hash "hash".
+ * If there is such an entry, then mark it as the most recently used entry.
+ * Return NULL if there is no such entry.
+ */
+static struct isl_basic_map_cache_entry *find(isl_ctx *ctx,
+	struct isl_basic_map_cache *cache, __isl_keep isl_basic_map *bmap,
+	enum isl_basic_map_cache_op op, uint32_t hash)
+{
+	struct isl_basic_map_cache_key key = { op, bmap };
+	struct isl_hash_table_entry *table_entry;
+	struct isl_basic_map_cache_entry *entry;
+
+	table_entry = isl_hash_table_find(ctx, &cache->table, hash,
+					&has_key, &key, 0);
+	if (!table_entry || table_entry == isl_hash_table_entry_none) {
+		ctx->stats->basic_map_cache_miss++;
+		return NULL;
+	}
+	ctx->stats->basic_map_cache_hit++;
+	entry = table_entry->data;
+	unlink_entry(cache, entry);
+	link_entry(cache, entry);
+	return entry;
+}
+
+/* Add an entry for operation "op" applied to "key" with hash "hash" and
+ * with outcome "verdict" or result "res" to "cache".
+ * The entry takes ownership of "key" and "res".
+ *
+ * The entry is only added if it fits within the size limit
+ * of the cache, after evicting the least recently used entries.
+ * Failure to add an entry is not considered to be an error
+ * since the cache is only used to speed up the computations.
+ */
+static void add(isl_ctx *ctx, struct isl_basic_map_cache *cache,
+	uint32_t hash, enum isl_basic_map_cache_op op,
+	__isl_take isl_basic_map *key, isl_bool verdict,
+	__isl_take isl_basic_map *res)
+{
+	struct isl_basic_map_cache_key lookup = { op, key };
+	struct isl_hash_table_entry *table_entry;
+	struct isl_basic_map_cache_entry *entry;
+	size_t limit = ctx->opt->basic_map_cache_size;
+	size_t size;
+
+	if (!key)
+		goto done;
+	size = sizeof(*entry) + basic_map_size(key) + basic_map_size(res);
+	if (size > limit)
+		goto done;
+	while (cache->last && cache->size + size > limit)
+		evict(ctx, cache);
+
+	table_entry = isl_hash_table_find(ctx, &cache->table, hash,
+					&has_key, &lookup, 1);
+	if (!table_entry || table_entry->data)
+		goto done;
+	entry = isl_calloc_type(ctx, struct isl_basic_map_cache_entry);
+	if (!entry) {
+		isl_hash_table_remove(ctx, &cache->table, table_entry);
+		goto done;
+	}
+	entry->hash = hash;
+	entry->op = op;
+	entry->key = key;
+	entry->res = res;
+	entry->verdict = verdict;
+	entry->size = size;
+	table_entry->data = entry;
+	link_entry(cache, entry);
+	cache->size += size;
+	return;
+done:
+	isl_basic_map_free(key);
+	isl_basic_map_free(res);
+}
+
+/* Return a copy of "bmap" for use as a key in the cache.
+ * The sample point is not needed in the key.
+ */
+static __isl_give isl_basic_map *dup_key(__isl_keep isl_basic_map *bmap)
+{
+	isl_basic_map *key;
+
+	key = isl_basic_map_dup(bmap);
+	if (!key)
+		return NULL;
+	isl_vec_free(key->sample);
+	key->sample = NULL;
+	return key;
+}
+
+/* Return a copy of the cached result "res" to replace "bmap".
+ *
+ * The caller of the operation may rely on the room for extra
+ * constraints and local variables that was available in "bmap",
+ * so make sure the copy has at least as much room.
+ * Since the cached result has no room to spare,
+ * isl_basic_map_extend creates a fresh copy if any room is needed.
+ */
+static __isl_give isl_basic_map *copy_result(__isl_keep isl_basic_map *res,
+	__isl_keep isl_basic_map *bmap)
+{
+	unsigned extra = 0, n_con = 0;
+	unsigned flags = res->flags;
+	isl_basic_map *copy;
+
+	if (bmap->extra > res->n_div)
+		extra = bmap->extra - res->n_div;
+	if (bmap->c_size > res->n_eq + res->n_ineq)
+		n_con = bmap->c_size - (res->n_eq + res->n_ineq);
+	if (!extra && !n_con)
+		return isl_basic_map_dup(res);
+
+	copy = isl_basic_map_extend(isl_basic_map_copy(res), extra, 0, n_con);
+	if (copy)
+		copy->flags = flags;
+	return copy;
+}
+
+/* Apply the test "test" corresponding to operation "op" to "bmap",
+ * reusing the outcome of a previous application
+ * to an identical basic map from the cache of the context, if any.
+ *
+ * If caching is disabled, then simply call "test".
+ * Otherwise, look for a cached outcome and
+ * store the outcome in the cache if none is found.
+ */
+isl_bool isl_basic_map_cache_test(__isl_keep isl_basic_map *bmap,
+	enum isl_basic_map_cache_op op,
+	isl_bool (*test)(__isl_keep isl_basic_map *bmap))
+{
+	isl_ctx *ctx;
+	struct isl_basic_map_cache *cache;
+	struct isl_basic_map_cache_entry *entry;
+	isl_basic_map *key;
+	isl_bool verdict;
+	isl_size total;
+	uint32_t hash;
+
+	if (!bmap)
+		return isl_bool_error;
+	ctx = isl_basic_map_get_ctx(bmap);
+	cache = get_cache(ctx);
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (!cache || total < 0)
+		return test(bmap);
+
+	hash = basic_map_cache_hash(bmap, op, total);
+	entry = find(ctx, cache, bmap, op, hash);
+	if (entry)
+		return entry->verdict;
+
+	key = dup_key(bmap);
+	verdict = test(bmap);
+	if (verdict < 0)
+		isl_basic_map_free(key);
+	else
+		add(ctx, cache, hash, op, key, verdict, NULL);
+
+	return verdict;
+}
+
+/* Apply the transformation "fn" corresponding to operation "op" to "bmap",
+ * reusing the result of a previous application
+ * to an identical basic map from the cache of the context, if any.
+ *
+ * If caching is disabled, then simply call "fn".
+ * Otherwise, look for a cached result and
+ * store the result in the cache if none is found.
+ * If "fn" leaves "bmap" unchanged, then only the input is stored
+ * and a later lookup simply returns its input.
+ *
+ * A copy of a cached result is returned (rather than
+ * an extra reference to the cached basic map)
+ * such that the caller gets a basic map with a single reference,
+ * as it would from "fn" on an input with a single reference.
+ */
+__isl_give isl_basic_map *isl_basic_map_cache_apply(
+	__isl_take isl_basic_map *bmap, enum isl_basic_map_cache_op op,
+	__isl_give isl_basic_map *(*fn)(__isl_take isl_basic_map *bmap))
+{
+	isl_ctx *ctx;
+	struct isl_basic_map_cache *cache;
+	struct isl_basic_map_cache_entry *entry;
+	isl_basic_map *key, *res;
+	isl_bool identical;
+	isl_size total;
+	uint32_t hash;
+
+	if (!bmap)
+		return NULL;
+	ctx = isl_basic_map_get_ctx(bmap);
+	cache = get_cache(ctx);
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (!cache || total < 0)
+		return fn(bmap);
+
+	hash = basic_map_cache_hash(bmap, op, total);
+	entry = find(ctx, cache, bmap, op, hash);
+	if (entry) {
+		if (!entry->res)
+			return bmap;
+		res = copy_result(entry->res, bmap);
+		isl_basic_map_free(bmap);
+		return res;
+	}
+
+	key = dup_key(bmap);
+	bmap = fn(bmap);
+	if (!bmap || !key) {
+		isl_basic_map_free(key);
+		return bmap;
+	}
+
+	identical = basic_map_is_identical(key, bmap);
+	if (identical < 0) {
+		isl_basic_map_free(key);
+		return isl_basic_map_free(bmap);
+	}
+	res = identical ? NULL : dup_key(bmap);
+	if (identical || res)
+		add(ctx, cache, hash, op, key, isl_bool_true, res);
+	else
+		isl_basic_map_free(key);
+
+	return bmap;
+}
+
+/* Free the cache of results of operations on basic maps of "ctx", if any.
+ */
+void isl_basic_map_cache_free(isl_ctx *ctx)
+{
+	struct isl_basic_map_cache *cache = ctx->bmap_cache;
+	struct isl_basic_map_cache_entry *entry, *next;
+
+	if (!cache)
+		return;
+	for (entry = cache->first; entry; entry = next) {
+		next = entry->next;
+		free_entry(entry);
+	}
+	isl_hash_table_clear(&cache->table);
+	free(cache);
+	ctx->bmap_cache = NULL;
+}
@@ -0,0 +1,26 @@
+#ifndef ISL_BASIC_MAP_CACHE_H
+#define ISL_BASIC_MAP_CACHE_H
+
+#include <isl/ctx.h>
+#include <isl/map_type.h>
+
+/* The operations on basic maps whose results may be cached.
+ */
+enum isl_basic_map_cache_op {
+	isl_basic_map_cache_is_empty,
+	isl_basic_map_cache_simplify,
+	isl_basic_map_cache_remove_redundancies
+};
+
+struct isl_basic_map_cache;
+
+isl_bool isl_basic_map_cache_test(__isl_keep isl_basic_map *bmap,
+	enum isl_basic_map_cache_op op,
+	isl_bool (*test)(__isl_keep isl_basic_map *bmap));
+__isl_give isl_basic_map *isl_basic_map_cache_apply(
+	__isl_take isl_basic_map *bmap, enum isl_basic_map_cache_op op,
+	__isl_give isl_basic_map *(*fn)(__isl_take isl_basic_map *bmap));
+
+void isl_basic_map_cache_free(isl_ctx *ctx);
+
+#endif
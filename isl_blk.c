@@ -10,9 +10,6 @@
 #include <isl_blk.h>
 #include <isl_ctx_private.h>
 
-/* The maximal number of cache misses before first element is evicted */
-#define ISL_BLK_MAX_MISS	100
-
 struct isl_blk isl_blk_empty()
 {
 	struct isl_blk block;
@@ -39,6 +36,75 @@ int isl_blk_is_error(struct isl_blk block)
 	return block.size == -1 && block.data == NULL;
 }
 
+/* Return the number of elements in the blocks of size class "c".
+ * Size class ISL_BLK_FINE + 4 * (k - ISL_BLK_FINE) + j, with 0 <= j < 4,
+ * contains blocks of 2^k + j * 2^(k - 2) elements.
+ */
+static size_t class_size(int c)
+{
+	int k;
+
+	if (c < ISL_BLK_FINE)
+		return (size_t) 1 << c;
+	c -= ISL_BLK_FINE;
+	k = ISL_BLK_FINE + c / 4;
+	return (size_t) (4 + c % 4) << (k - 2);
+}
+
+/* Return the size class of blocks that can hold "n" elements,
+ * i.e., the smallest "c" such that class_size(c) >= n,
+ * or ISL_BLK_N_CLASS if there is no such (cached) size class.
+ *
+ * First compute the smallest "k" such that 2^k >= n.
+ * If k > ISL_BLK_FINE, then 2^(k-1) < n <= 2^k and
+ * "j" is the number of steps of 2^(k - 3) (a quarter of 2^(k-1))
+ * needed to reach "n" from 2^(k-1).
+ */
+static int size_class(size_t n)
+{
+	int k;
+	size_t j;
+
+	for (k = 0; k <= ISL_BLK_MAX_LOG; ++k)
+		if (((size_t) 1 << k) >= n)
+			break;
+	if (k > ISL_BLK_MAX_LOG)
+		return ISL_BLK_N_CLASS;
+	if (k <= ISL_BLK_FINE)
+		return k;
+	j = (n - ((size_t) 1 << (k - 1)) + ((size_t) 1 << (k - 3)) - 1) >>
+		(k - 3);
+	return ISL_BLK_FINE + 4 * (k - 1 - ISL_BLK_FINE) + j;
+}
+
+/* Return the number of elements that should be allocated
+ * for a block of (at least) "n" elements.
+ * That is, round "n" up to the size of its size class, if any.
+ */
+static size_t alloc_size(size_t n)
+{
+	int c;
+
+	c = size_class(n);
+	if (c >= ISL_BLK_N_CLASS)
+		return n;
+	return class_size(c);
+}
+
+/* Return the size class in which "block" can be cached or
+ * -1 if it cannot be cached.
+ * Only blocks that have exactly the size of a size class can be cached.
+ */
+static int cache_class(struct isl_blk block)
+{
+	int c;
+
+	c = size_class(block.size);
+	if (c >= ISL_BLK_N_CLASS || class_size(c) != block.size)
+		return -1;
+	return c;
+}
+
 static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 {
 	int i;
@@ -48,6 +114,12 @@ static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 	free(block.data);
 }
 
+/* Extend "block" to hold at least "new_n" elements.
+ * The new size is rounded up to a size class such that
+ * the block can be cached when it gets freed and
+ * such that subsequent small extensions do not require
+ * a reallocation.
+ */
 static struct isl_blk extend(struct isl_ctx *ctx, struct isl_blk block,
 				size_t new_n)
 {
@@ -57,6 +129,8 @@ static struct isl_blk extend(struct isl_ctx *ctx, struct isl_blk block,
 	if (block.size >= new_n)
 		return block;
 
+	new_n = alloc_size(new_n);
+	ctx->stats->blk_malloc++;
 	p = isl_realloc_array(ctx, block.data, isl_int, new_n);
 	if (!p) {
 		isl_blk_free_force(ctx, block);
@@ -71,34 +145,27 @@ static struct isl_blk extend(struct isl_ctx *ctx, struct isl_blk block,
 	return block;
 }
 
+/* Allocate a block of at least "n" elements,
+ * taking it from the cache of "ctx" if possible.
+ */
 struct isl_blk isl_blk_alloc(struct isl_ctx *ctx, size_t n)
 {
-	int i;
+	int c;
 	struct isl_blk block;
+	struct isl_blk_cache *cache = &ctx->blk_cache;
 
 	block = isl_blk_empty();
-	if (n && ctx->n_cached) {
-		int best = 0;
-		for (i = 1; ctx->cache[best].size != n && i < ctx->n_cached; ++i) {
-			if (ctx->cache[best].size < n) {
-				if (ctx->cache[i].size > ctx->cache[best].size)
-					best = i;
-			} else if (ctx->cache[i].size >= n &&
-				   ctx->cache[i].size < ctx->cache[best].size)
-					best = i;
-		}
-		if (ctx->cache[best].size < 2 * n + 100) {
-			block = ctx->cache[best];
-			if (--ctx->n_cached != best)
-				ctx->cache[best] = ctx->cache[ctx->n_cached];
-			if (best == 0)
-				ctx->n_miss = 0;
-		} else if (ctx->n_miss++ >= ISL_BLK_MAX_MISS) {
-			isl_blk_free_force(ctx, ctx->cache[0]);
-			if (--ctx->n_cached != 0)
-				ctx->cache[0] = ctx->cache[ctx->n_cached];
-			ctx->n_miss = 0;
-		}
+	if (n == 0)
+		return block;
+
+	ctx->stats->blk_alloc++;
+	c = size_class(n);
+	if (c < ISL_BLK_N_CLASS && cache->n[c] > 0) {
+		block.size = class_size(c);
+		block.data = cache->data[c][--cache->n[c]];
+		cache->n_el -= block.size;
+		ctx->stats->blk_cache_hit++;
+		return block;
 	}
 
 	return extend(ctx, block, n);
@@ -113,22 +180,108 @@ struct isl_blk isl_blk_extend(struct isl_ctx *ctx, struct isl_blk block,
 	return extend(ctx, block, new_n);
 }
 
+/* Can a block of size class "c" be added to "cache"?
+ *
+ * Inside a block retention scope, there is no limit
+ * on the number of cached blocks.
+ * Otherwise, the block is only kept if there is still room for it
+ * in its size class and if the total number of cached elements
+ * remains within bounds.
+ */
+static int can_cache(struct isl_blk_cache *cache, int c)
+{
+	if (cache->retain)
+		return 1;
+	return cache->n[c] < ISL_BLK_CLASS_CACHE_SIZE &&
+	    cache->n_el + class_size(c) <= ISL_BLK_MAX_CACHED;
+}
+
+/* Make sure there is room for at least one more block
+ * in size class "c" of the cache of "ctx".
+ * The room is allocated directly since this function
+ * should not be affected by the operation count of "ctx".
+ */
+static isl_stat ensure_room(struct isl_ctx *ctx, int c)
+{
+	int size;
+	isl_int **data;
+	struct isl_blk_cache *cache = &ctx->blk_cache;
+
+	if (cache->n[c] < cache->size[c])
+		return isl_stat_ok;
+
+	size = cache->size[c] ? 2 * cache->size[c] : ISL_BLK_CLASS_CACHE_SIZE;
+	data = realloc(cache->data[c], size * sizeof(isl_int *));
+	if (!data)
+		return isl_stat_error;
+	cache->data[c] = data;
+	cache->size[c] = size;
+
+	return isl_stat_ok;
+}
+
+/* Free "block" or keep it in the cache of "ctx" for later reuse.
+ * The block is only kept if it belongs to a size class and
+ * if there is room for it in the cache.
+ * A frozen context may be shared by several threads,
+ * so its cache is not used.
+ */
 void isl_blk_free(struct isl_ctx *ctx, struct isl_blk block)
 {
+	int c;
+	struct isl_blk_cache *cache = &ctx->blk_cache;
+
 	if (isl_blk_is_empty(block) || isl_blk_is_error(block))
 		return;
 
-	if (ctx->n_cached < ISL_BLK_CACHE_SIZE)
-		ctx->cache[ctx->n_cached++] = block;
-	else
+	c = cache_class(block);
+	if (!ctx->frozen && c >= 0 && can_cache(cache, c) &&
+	    ensure_room(ctx, c) >= 0) {
+		cache->data[c][cache->n[c]++] = block.data;
+		cache->n_el += block.size;
+	} else
 		isl_blk_free_force(ctx, block);
 }
 
+/* Free the last cached block in size class "c" of "cache".
+ */
+static void drop_cached(struct isl_ctx *ctx, struct isl_blk_cache *cache,
+	int c)
+{
+	struct isl_blk block;
+
+	block.size = class_size(c);
+	block.data = cache->data[c][--cache->n[c]];
+	cache->n_el -= block.size;
+	isl_blk_free_force(ctx, block);
+}
+
+/* Reduce the cache of "ctx" to the size limits that apply
+ * outside of a block retention scope, starting with the largest blocks.
+ */
+void isl_blk_trim_cache(struct isl_ctx *ctx)
+{
+	int c;
+	struct isl_blk_cache *cache = &ctx->blk_cache;
+
+	for (c = ISL_BLK_N_CLASS - 1; c >= 0; --c) {
+		while (cache->n[c] > ISL_BLK_CLASS_CACHE_SIZE)
+			drop_cached(ctx, cache, c);
+		while (cache->n[c] > 0 && cache->n_el > ISL_BLK_MAX_CACHED)
+			drop_cached(ctx, cache, c);
+	}
+}
+
 void isl_blk_clear_cache(struct isl_ctx *ctx)
 {
-	int i;
+	int c;
+	struct isl_blk_cache *cache = &ctx->blk_cache;
 
-	for (i = 0; i < ctx->n_cached; ++i)
-		isl_blk_free_force(ctx, ctx->cache[i]);
-	ctx->n_cached = 0;
+	for (c = 0; c < ISL_BLK_N_CLASS; ++c) {
+		while (cache->n[c] > 0)
+			drop_cached(ctx, cache, c);
+		free(cache->data[c]);
+		cache->data[c] = NULL;
+		cache->size[c] = 0;
+	}
 }
@@ -21,7 +21,41 @@ struct isl_blk {
 	isl_int *data;
 };
 
-#define ISL_BLK_CACHE_SIZE	20
+/* Freed blocks are cached per size class.
+ * The first ISL_BLK_FINE size classes contain blocks of 2^c elements.
+ * From 2^ISL_BLK_FINE elements onwards, each power of two
+ * is split into four size classes, such that rounding up
+ * the size of a large block to its size class wastes
+ * at most a quarter of the block.
+ * Only blocks of at most 2^ISL_BLK_MAX_LOG elements
+ * belong to a size class.
+ * Outside of a block retention scope (see isl_ctx_push_block_retention),
+ * at most ISL_BLK_CLASS_CACHE_SIZE blocks are kept per size class and
+ * the total number of elements in cached blocks is at most
+ * ISL_BLK_MAX_CACHED.
+ */
+#define ISL_BLK_FINE			6
+#define ISL_BLK_MAX_LOG			15
+#define ISL_BLK_N_CLASS							\
+	(ISL_BLK_FINE + 4 * (ISL_BLK_MAX_LOG - ISL_BLK_FINE) + 1)
+#define ISL_BLK_CLASS_CACHE_SIZE	16
+#define ISL_BLK_MAX_CACHED		(1 << 16)
+
+/* A cache of freed blocks.
+ * "n[c]" is the number of cached blocks in size class "c" and
+ * "data[c]" contains the elements of those blocks.
+ * "size[c]" is the number of blocks that fit in "data[c]".
+ * "n_el" is the total number of elements in all cached blocks.
+ * "retain" is the number of currently open block retention scopes.
+ * Inside such a scope, all freed blocks in a size class are kept.
+ */
+struct isl_blk_cache {
+	size_t n_el;
+	int retain;
+	int n[ISL_BLK_N_CLASS];
+	int size[ISL_BLK_N_CLASS];
+	isl_int **data[ISL_BLK_N_CLASS];
+};
 
 struct isl_ctx;
 
@@ -31,6 +65,7 @@ int isl_blk_is_error(struct isl_blk block);
 struct isl_blk isl_blk_extend(struct isl_ctx *ctx, struct isl_blk block,
 				size_t new_n);
 void isl_blk_free(struct isl_ctx *ctx, struct isl_blk block);
+void isl_blk_trim_cache(struct isl_ctx *ctx);
 void isl_blk_clear_cache(struct isl_ctx *ctx);
 
 #if defined(__cplusplus)
@@ -20,6 +20,7 @@
  * and Cerebras Systems, 175 S San Antonio Rd, Los Altos, CA, USA
  */
 
+#include <time.h>
 #include <isl_ctx_private.h>
 #include "isl_map_private.h"
 #include <isl_seq.h>
@@ -173,6 +174,36 @@ static int all(int *con, unsigned len, int status)
 	return 1;
 }
 
+/* A box containing a basic map, derived from those constraints
+ * of the basic map that involve a single variable.
+ * "lower" and "upper" contain the lower and upper bounds
+ * on each of the variables.  The bounds are only valid
+ * if the corresponding entry of "has_lower" or "has_upper" is set.
+ * "bmap" is the basic map from which the box was derived.
+ * It is only used to detect that the box needs to be recomputed and
+ * is therefore not a reference to the basic map.
+ */
+struct isl_coalesce_box {
+	isl_vec *lower;
+	isl_vec *upper;
+	char *has_lower;
+	char *has_upper;
+};
+
+/* Free the memory allocated by "box" and reset it.
+ */
+static void box_clear(struct isl_coalesce_box *box)
+{
+	isl_vec_free(box->lower);
+	isl_vec_free(box->upper);
+	free(box->has_lower);
+	free(box->has_upper);
+	box->lower = NULL;
+	box->upper = NULL;
+	box->has_lower = NULL;
+	box->has_upper = NULL;
+}
+
 /* Internal information associated to a basic map in a map
  * that is to be coalesced by isl_map_coalesce.
  *
@@ -193,6 +224,10 @@ static int all(int *con, unsigned len, int status)
  * the other basic map.  The number of elements in the "eq" array
  * is twice the number of equalities in the "bmap", corresponding
  * to the two inequalities that make up each equality.
+ *
+ * "box" is a box around "bmap" that is computed by get_box
+ * when it is first needed.  It is invalidated by invalidate_box
+ * whenever "bmap" is replaced or modified.
  */
 struct isl_coalesce_info {
 	isl_basic_map *bmap;
@@ -203,6 +238,7 @@ struct isl_coalesce_info {
 	int simplify;
 	int *eq;
 	int *ineq;
+	struct isl_coalesce_box box;
 };
 
 /* Is there any (half of an) equality constraint in the description
@@ -346,11 +382,21 @@ static void clear_coalesce_info(int n, struct isl_coalesce_info *info)
 	for (i = 0; i < n; ++i) {
 		isl_basic_map_free(info[i].bmap);
 		isl_tab_free(info[i].tab);
+		box_clear(&info[i].box);
 	}
 
 	free(info);
 }
 
+/* Invalidate the box around the basic map represented by "info"
+ * after this basic map has been replaced or modified,
+ * such that get_box recomputes it when it is needed again.
+ */
+static void invalidate_box(struct isl_coalesce_info *info)
+{
+	box_clear(&info->box);
+}
+
 /* Clear the memory associated to "info".
  */
 static void clear(struct isl_coalesce_info *info)
@@ -358,6 +404,7 @@ static void clear(struct isl_coalesce_info *info)
 	info->bmap = isl_basic_map_free(info->bmap);
 	isl_tab_free(info->tab);
 	info->tab = NULL;
+	invalidate_box(info);
 }
 
 /* Drop the basic map represented by "info".
@@ -1054,6 +1101,7 @@ static enum isl_change extend(int i, int j, int n, int *relax,
 	int l;
 	isl_size total;
 
+	invalidate_box(&info[i]);
 	info[i].bmap = isl_basic_map_cow(info[i].bmap);
 	total = isl_basic_map_dim(info[i].bmap, isl_dim_all);
 	if (total < 0)
@@ -2629,16 +2677,219 @@ error:
 	return isl_change_error;
 }
 
+/* Update "box" based on the constraint "c" of length 1 + "total",
+ * which involves only the variable at position "pos".
+ * If "eq" is set, then "c" is an equality constraint.
+ * "t" is a temporary variable.
+ *
+ * A constraint a x + c >= 0 is a lower bound ceil(-c/a) on x if a > 0 and
+ * an upper bound floor(-c/a) on x if a < 0.
+ * An equality constraint a x + c = 0 provides both bounds.
+ */
+static void box_add_constraint(struct isl_coalesce_box *box, isl_int *c,
+	int pos, int eq, isl_int t)
+{
+	isl_int *a = &c[1 + pos];
+
+	if (eq || isl_int_is_pos(*a)) {
+		isl_int_neg(t, c[0]);
+		isl_int_cdiv_q(t, t, *a);
+		if (!box->has_lower[pos] || isl_int_gt(t, box->lower->el[pos]))
+			isl_int_set(box->lower->el[pos], t);
+		box->has_lower[pos] = 1;
+	}
+	if (eq || isl_int_is_neg(*a)) {
+		isl_int_neg(t, c[0]);
+		isl_int_fdiv_q(t, t, *a);
+		if (!box->has_upper[pos] || isl_int_lt(t, box->upper->el[pos]))
+			isl_int_set(box->upper->el[pos], t);
+		box->has_upper[pos] = 1;
+	}
+}
+
+/* Update "box" based on those of the "n" constraints "c"
+ * of length 1 + "total" that involve a single variable.
+ * If "eq" is set, then the constraints are equality constraints.
+ */
+static void box_add_constraints(struct isl_coalesce_box *box, isl_int **c,
+	int n, int eq, int total, isl_int t)
+{
+	int k, pos;
+
+	for (k = 0; k < n; ++k) {
+		pos = isl_seq_first_non_zero(c[k] + 1, total);
+		if (pos < 0)
+			continue;
+		if (isl_seq_first_non_zero(c[k] + 1 + pos + 1,
+					    total - pos - 1) >= 0)
+			continue;
+		box_add_constraint(box, c[k], pos, eq, t);
+	}
+}
+
+/* Construct the box of "bmap", with "total" variables.
+ */
+static isl_stat box_init(struct isl_coalesce_box *box,
+	__isl_keep isl_basic_map *bmap, int total)
+{
+	isl_ctx *ctx = isl_basic_map_get_ctx(bmap);
+	isl_int t;
+
+	box->lower = isl_vec_alloc(ctx, total);
+	box->upper = isl_vec_alloc(ctx, total);
+	box->has_lower = isl_calloc_array(ctx, char, total);
+	box->has_upper = isl_calloc_array(ctx, char, total);
+	if (!box->lower || !box->upper ||
+	    (total && (!box->has_lower || !box->has_upper)))
+		return isl_stat_error;
+
+	isl_int_init(t);
+	box_add_constraints(box, bmap->eq, bmap->n_eq, 1, total, t);
+	box_add_constraints(box, bmap->ineq, bmap->n_ineq, 0, total, t);
+	isl_int_clear(t);
+
+	return isl_stat_ok;
+}
+
+/* Return the box around the basic map represented by "info",
+ * which has "total" variables.
+ * The box is only computed once for each basic map,
+ * rather than each time the basic map is compared to another basic map.
+ * Every operation that replaces or modifies info->bmap
+ * calls invalidate_box, such that the box is recomputed
+ * the next time it is needed.
+ * The number of variables is checked explicitly
+ * since the box is indexed by the variables.
+ */
+static struct isl_coalesce_box *get_box(struct isl_coalesce_info *info,
+	int total)
+{
+	struct isl_coalesce_box *box = &info->box;
+
+	if (box->lower && box->lower->size == total)
+		return box;
+
+	box_clear(box);
+	if (box_init(box, info->bmap, total) < 0) {
+		box_clear(box);
+		return NULL;
+	}
+
+	return box;
+}
+
+/* Is the inequality "ineq" of length 1 + "total" violated
+ * by every point in "box"?
+ * That is, is the maximal value of the affine expression over "box" negative?
+ * "sum" is a temporary variable.
+ */
+static int box_violates(struct isl_coalesce_box *box, isl_int *ineq,
+	int total, isl_int sum)
+{
+	int v;
+
+	isl_int_set(sum, ineq[0]);
+	for (v = 0; v < total; ++v) {
+		if (isl_int_is_zero(ineq[1 + v]))
+			continue;
+		if (isl_int_is_pos(ineq[1 + v])) {
+			if (!box->has_upper[v])
+				return 0;
+			isl_int_addmul(sum, ineq[1 + v], box->upper->el[v]);
+		} else {
+			if (!box->has_lower[v])
+				return 0;
+			isl_int_addmul(sum, ineq[1 + v], box->lower->el[v]);
+		}
+	}
+
+	return isl_int_is_neg(sum);
+}
+
+/* Is there an inequality constraint of the basic map represented by "info_i"
+ * that separates it from the basic map represented by "info_j"?
+ *
+ * The inequality constraints that are violated by every point
+ * in a box around the basic map represented by "info_j"
+ * are likely to be separating constraints.
+ * Only these are checked against the tableau of "info_j".
+ * Constraints that are known to be redundant are skipped,
+ * as in ineq_status_in.
+ *
+ * If this function returns true, then coalesce_local_pair_reuse
+ * would also find a separating inequality constraint and
+ * give up on the pair.
+ * The box only helps in deciding which constraints to check first.
+ * Note that a constraint that is violated by every point in the box
+ * may still be adjacent to a constraint of "info_j", rather than
+ * separating, especially in the presence of integer divisions.
+ */
+static isl_bool box_separated(struct isl_coalesce_info *info_i,
+	struct isl_coalesce_info *info_j)
+{
+	int k;
+	isl_size total;
+	isl_bool separated = isl_bool_false;
+	struct isl_coalesce_box *box;
+	isl_basic_map *bmap_i = info_i->bmap;
+	isl_int sum;
+
+	total = isl_basic_map_dim(bmap_i, isl_dim_all);
+	if (total < 0)
+		return isl_bool_error;
+	box = get_box(info_j, total);
+	if (!box)
+		return isl_bool_error;
+
+	isl_int_init(sum);
+	for (k = 0; k < bmap_i->n_ineq; ++k) {
+		int status;
+
+		if (info_i->tab &&
+		    isl_tab_is_redundant(info_i->tab, bmap_i->n_eq + k))
+			continue;
+		if (!box_violates(box, bmap_i->ineq[k], total, sum))
+			continue;
+		status = status_in(bmap_i->ineq[k], info_j->tab);
+		if (status == STATUS_ERROR)
+			separated = isl_bool_error;
+		if (status == STATUS_ERROR || status == STATUS_SEPARATE)
+			break;
+	}
+	if (separated >= 0 && k < bmap_i->n_ineq)
+		separated = isl_bool_true;
+	isl_int_clear(sum);
+
+	return separated;
+}
+
 /* Check if the union of the given pair of basic maps
  * can be represented by a single basic map.
  * If so, replace the pair by the single basic map and return
  * isl_change_drop_first, isl_change_drop_second or isl_change_fuse.
  * Otherwise, return isl_change_none.
  * The two basic maps are assumed to live in the same local space.
+ *
+ * Most pairs of basic maps in a map with many disjuncts
+ * are separated by an inequality constraint of one of them,
+ * in which case coalesce_local_pair_reuse gives up on the pair.
+ * Look for such a constraint among the likely candidates first,
+ * to avoid computing the position of all constraints
+ * with respect to the other basic map.
  */
 static enum isl_change coalesce_local_pair(int i, int j,
 	struct isl_coalesce_info *info)
 {
+	isl_bool separated;
+
+	separated = box_separated(&info[i], &info[j]);
+	if (separated >= 0 && !separated)
+		separated = box_separated(&info[j], &info[i]);
+	if (separated < 0)
+		return isl_change_error;
+	if (separated)
+		return isl_change_none;
+
 	init_status(&info[i]);
 	init_status(&info[j]);
 	return coalesce_local_pair_reuse(i, j, info);
@@ -2660,6 +2911,7 @@ static isl_stat shift_div(struct isl_coalesce_info *info, int div,
 {
 	isl_size total, n_div;
 
+	invalidate_box(info);
 	info->bmap = isl_basic_map_shift_div(info->bmap, div, 0, shift);
 	if (!info->bmap)
 		return isl_stat_error;
@@ -2733,6 +2985,7 @@ static isl_stat normalize_stride_div(struct isl_coalesce_info *info, int div)
 		return isl_stat_error;
 	if (!valid)
 		return isl_stat_ok;
+	invalidate_box(info);
 	info->bmap = isl_basic_map_set_div_expr_constant_num_si_inplace(
 							    info->bmap, div, 0);
 	if (!info->bmap)
@@ -3073,6 +3326,7 @@ static isl_stat fix_constant_divs(struct isl_coalesce_info *info,
 	int i;
 	isl_vec *ineq;
 
+	invalidate_box(info);
 	o_div = isl_basic_map_offset(info->bmap, isl_dim_div) - 1;
 	ineq = isl_vec_alloc(isl_tab_get_ctx(info->tab), 1 + info->tab->n_var);
 	if (!ineq)
@@ -3176,6 +3430,7 @@ static isl_stat tab_insert_divs(struct isl_coalesce_info *info,
 
 	isl_basic_map_free(info->bmap);
 	info->bmap = bmap;
+	invalidate_box(info);
 
 	any = 0;
 	for (i = 0; i < n; ++i) {
@@ -3333,6 +3588,7 @@ static enum isl_change coalesce_expand_tab_divs(__isl_take isl_basic_map *bmap,
 	} else {
 		isl_basic_map_free(info[i].bmap);
 		info[i].bmap = bmap_i;
+		invalidate_box(&info[i]);
 
 		if (isl_tab_rollback(info[i].tab, snap) < 0)
 			change = isl_change_error;
@@ -3718,6 +3974,7 @@ static isl_stat add_sub_vars(struct isl_coalesce_info *info,
 	int i, j, d;
 	isl_size n;
 
+	invalidate_box(info);
 	info->bmap = isl_basic_map_cow(info->bmap);
 	info->bmap = isl_basic_map_extend(info->bmap, extra_var, 0, 0);
 	n = isl_aff_list_n_aff(list);
@@ -3870,6 +4127,7 @@ static enum isl_change coalesce_with_subs(int i, int j,
 	} else {
 		isl_basic_map_free(info[j].bmap);
 		info[j].bmap = bmap_j;
+		invalidate_box(&info[j]);
 
 		if (isl_tab_rollback(info[j].tab, snap) < 0)
 			return isl_change_error;
@@ -4013,6 +4271,8 @@ static enum isl_change coalesce_pair(int i, int j,
 	enum isl_change change;
 	isl_ctx *ctx;
 
+	ctx = isl_basic_map_get_ctx(info[i].bmap);
+	ctx->stats->coalesce_pairs++;
 	if (harmonize_divs(&info[i], &info[j]) < 0)
 		return isl_change_error;
 	same = same_divs(info[i].bmap, info[j].bmap);
@@ -4021,7 +4281,6 @@ static enum isl_change coalesce_pair(int i, int j,
 	if (same)
 		return coalesce_local_pair(i, j, info);
 
-	ctx = isl_basic_map_get_ctx(info[i].bmap);
 	preserve = isl_options_get_coalesce_preserve_locals(ctx);
 	if (!preserve && info[i].bmap->n_div == info[j].bmap->n_div) {
 		change = coalesce_local_pair(i, j, info);
@@ -4199,6 +4458,7 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 	int i;
 	unsigned n;
 	isl_ctx *ctx;
+	clock_t start;
 	struct isl_coalesce_info *info = NULL;
 
 	map = isl_map_remove_empty_parts(map);
@@ -4209,13 +4469,14 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 		return map;
 
 	ctx = isl_map_get_ctx(map);
+	start = isl_ctx_clock(ctx);
+	n = map->n;
+	isl_ctx_trace_begin(ctx, "isl_map_coalesce", n);
 	map = isl_map_sort_divs(map);
 	map = isl_map_cow(map);
 
 	if (!map)
-		return NULL;
-
-	n = map->n;
+		goto error;
 
 	info = isl_calloc_array(map->ctx, struct isl_coalesce_info, n);
 	if (!info)
@@ -4253,10 +4514,13 @@ __isl_give isl_map *isl_map_coalesce(__isl_take isl_map *map)
 
 	clear_coalesce_info(n, info);
 
+	ctx->stats->coalesce_clock += isl_ctx_clock(ctx) - start;
+	isl_ctx_trace_end(ctx, "isl_map_coalesce", n);
 	return map;
 error:
 	clear_coalesce_info(n, info);
 	isl_map_free(map);
+	isl_ctx_trace_end(ctx, "isl_map_coalesce", n);
 	return NULL;
 }
 
@@ -22,6 +22,7 @@
 #include "isl_equalities.h"
 #include "isl_tab.h"
 #include <isl_sort.h>
+#include <isl_basic_map_cache.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -48,22 +49,11 @@ static __isl_give isl_basic_set *uset_convex_hull_wrap_bounded(
  * corresponding equality and then checked if the dimension was that
  * of a facet.
  */
-__isl_give isl_basic_map *isl_basic_map_remove_redundancies(
+static __isl_give isl_basic_map *basic_map_remove_redundancies(
 	__isl_take isl_basic_map *bmap)
 {
 	struct isl_tab *tab;
 
-	if (!bmap)
-		return NULL;
-
-	bmap = isl_basic_map_gauss(bmap, NULL);
-	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
-		return bmap;
-	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_NO_REDUNDANT))
-		return bmap;
-	if (bmap->n_ineq <= 1)
-		return bmap;
-
 	bmap = isl_basic_map_sort_constraints(bmap);
 	tab = isl_tab_from_basic_map(bmap, 0);
 	if (!tab)
@@ -89,6 +79,37 @@ error:
 	return NULL;
 }
 
+/* Remove redundant constraints from "bmap",
+ * reusing the result of an earlier removal from
+ * an identical basic map if the basic map cache is enabled.
+ * The cache is only consulted after the cheap checks
+ * for an empty basic map or a basic map that is known
+ * to have no redundant constraints and after dropping
+ * the constraints that are obviously redundant with respect
+ * to the bounds on individual variables.
+ */
+__isl_give isl_basic_map *isl_basic_map_remove_redundancies(
+	__isl_take isl_basic_map *bmap)
+{
+	if (!bmap)
+		return NULL;
+
+	bmap = isl_basic_map_gauss(bmap, NULL);
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
+		return bmap;
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_NO_REDUNDANT))
+		return bmap;
+	bmap = isl_basic_map_drop_redundant_by_bounds(bmap);
+	if (!bmap || ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
+		return bmap;
+	if (bmap->n_ineq <= 1)
+		return bmap;
+
+	return isl_basic_map_cache_apply(bmap,
+			isl_basic_map_cache_remove_redundancies,
+			&basic_map_remove_redundancies);
+}
+
 __isl_give isl_basic_set *isl_basic_set_remove_redundancies(
 	__isl_take isl_basic_set *bset)
 {
@@ -7,9 +7,18 @@
  * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
  */
 
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <isl_ctx_private.h>
+#include <isl_id_private.h>
 #include <isl/vec.h>
+#include <isl/printer.h>
 #include <isl_options_private.h>
+#include <isl_basic_map_cache.h>
+
+#define ARRAY_SIZE(array) (sizeof(array)/sizeof(*array))
 
 #define __isl_calloc(type,size)		((type *)calloc(1, size))
 #define __isl_calloc_type(type)		__isl_calloc(type,sizeof(type))
@@ -79,15 +88,20 @@ static void *check_non_null(isl_ctx *ctx, void *p, size_t size)
  *
  * In particular, we should stop if the user has explicitly aborted
  * the computation or if the maximal number of operations has been exceeded.
+ * A child context is also aborted when its parent is aborted.
+ * The operations performed in a frozen context are not counted
+ * since the context may be shared by several threads.
  */
 int isl_ctx_next_operation(isl_ctx *ctx)
 {
 	if (!ctx)
 		return -1;
-	if (ctx->abort) {
+	if (ctx->abort || (ctx->parent && ctx->parent->abort)) {
 		isl_ctx_set_error(ctx, isl_error_abort);
 		return -1;
 	}
+	if (ctx->frozen)
+		return 0;
 	if (ctx->max_operations && ctx->operations >= ctx->max_operations)
 		isl_die(ctx, isl_error_quota,
 			"maximal number of operations exceeded", return -1);
@@ -205,6 +219,25 @@ void *isl_ctx_peek_options(isl_ctx *ctx, struct isl_args *args)
 	return find_nested_options(ctx->user_args, ctx->user_opt, args);
 }
 
+/* Initialize the constants and the scratch integer of "ctx".
+ */
+static void init_constants(isl_ctx *ctx)
+{
+	isl_int_init(ctx->zero);
+	isl_int_set_si(ctx->zero, 0);
+
+	isl_int_init(ctx->one);
+	isl_int_set_si(ctx->one, 1);
+
+	isl_int_init(ctx->two);
+	isl_int_set_si(ctx->two, 2);
+
+	isl_int_init(ctx->negone);
+	isl_int_set_si(ctx->negone, -1);
+
+	isl_int_init(ctx->normalize_gcd);
+}
+
 isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 {
 	struct isl_ctx *ctx = NULL;
@@ -239,22 +272,7 @@ isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 	ctx->opt = opt;
 	ctx->ref = 0;
 
-	isl_int_init(ctx->zero);
-	isl_int_set_si(ctx->zero, 0);
-
-	isl_int_init(ctx->one);
-	isl_int_set_si(ctx->one, 1);
-
-	isl_int_init(ctx->two);
-	isl_int_set_si(ctx->two, 2);
-
-	isl_int_init(ctx->negone);
-	isl_int_set_si(ctx->negone, -1);
-
-	isl_int_init(ctx->normalize_gcd);
-
-	ctx->n_cached = 0;
-	ctx->n_miss = 0;
+	init_constants(ctx);
 
 	isl_ctx_reset_error(ctx);
 
@@ -279,6 +297,139 @@ struct isl_ctx *isl_ctx_alloc()
 	return isl_ctx_alloc_with_options(&isl_options_args, opt);
 }
 
+/* Freeze "ctx" such that child contexts can be allocated from it
+ * using isl_ctx_alloc_child.
+ *
+ * After freezing, the options of "ctx" should no longer be changed and
+ * no new identifiers can be created in "ctx".
+ * The identifiers that already exist in "ctx" are shared
+ * by all child contexts and remain alive until "ctx" itself is freed.
+ * The block cache is cleared since a frozen context
+ * no longer makes use of it.
+ */
+isl_stat isl_ctx_freeze(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->parent)
+		isl_die(ctx, isl_error_invalid,
+			"cannot freeze child context", return isl_stat_error);
+	isl_blk_clear_cache(ctx);
+	ctx->frozen = 1;
+	return isl_stat_ok;
+}
+
+/* Has "ctx" been frozen by isl_ctx_freeze?
+ */
+isl_bool isl_ctx_is_frozen(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_bool_error;
+	return isl_bool_ok(ctx->frozen);
+}
+
+/* Allocate a child context of the frozen context "parent".
+ *
+ * The child shares the options and the identifiers of "parent",
+ * but has its own block cache, statistics, error state and
+ * operation count.  The maximal number of operations is initialized
+ * to that of "parent".
+ * Different child contexts of the same parent may therefore
+ * be used concurrently in different threads.
+ * The child keeps a reference to "parent" such that "parent"
+ * cannot be freed before all its children have been freed.
+ */
+isl_ctx *isl_ctx_alloc_child(isl_ctx *parent)
+{
+	struct isl_ctx *ctx;
+
+	if (!parent)
+		return NULL;
+	if (!parent->frozen)
+		isl_die(parent, isl_error_invalid,
+			"parent context has not been frozen", return NULL);
+
+	ctx = __isl_calloc_type(struct isl_ctx);
+	if (!ctx)
+		isl_die(parent, isl_error_alloc, "allocation failure",
+			return NULL);
+
+	ctx->user_args = parent->user_args;
+	ctx->user_opt = parent->user_opt;
+	ctx->opt = parent->opt;
+	ctx->ref = 0;
+
+	if (isl_hash_table_init(ctx, &ctx->id_table, 0))
+		goto error;
+
+	ctx->stats = isl_calloc_type(ctx, struct isl_stats);
+	if (!ctx->stats)
+		goto error;
+
+	ctx->parent = parent;
+	isl_ctx_ref(parent);
+
+	init_constants(ctx);
+	isl_ctx_reset_error(ctx);
+	isl_ctx_set_max_operations(ctx, parent->max_operations);
+
+	return ctx;
+error:
+	isl_hash_table_clear(&ctx->id_table);
+	free(ctx);
+	return NULL;
+}
+
+/* Return the parent of "ctx" if it is a child context and NULL otherwise.
+ */
+isl_ctx *isl_ctx_get_parent(isl_ctx *ctx)
+{
+	return ctx ? ctx->parent : NULL;
+}
+
+/* Open a block retention scope in "ctx" for a computation that creates
+ * many short-lived objects.
+ *
+ * Inside such a scope, every freed block of integers is kept
+ * in the block cache of "ctx" for later reuse, such that the blocks
+ * of temporary objects are recycled without involving
+ * the system allocator.
+ * The number of cached blocks is then bounded by the maximal number
+ * of blocks that were simultaneously alive inside the scope.
+ * Objects themselves are still allocated and freed individually.
+ * A frozen context does not cache any blocks,
+ * so retention scopes have no effect on such a context.
+ */
+isl_stat isl_ctx_push_block_retention(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->frozen)
+		return isl_stat_ok;
+	ctx->blk_cache.retain++;
+	return isl_stat_ok;
+}
+
+/* Close the innermost block retention scope
+ * opened by isl_ctx_push_block_retention.
+ * When the outermost scope is closed, the block cache is trimmed
+ * back to its usual size.
+ */
+isl_stat isl_ctx_pop_block_retention(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->frozen)
+		return isl_stat_ok;
+	if (ctx->blk_cache.retain <= 0)
+		isl_die(ctx, isl_error_invalid,
+			"no block retention scope to close",
+			return isl_stat_error);
+	if (--ctx->blk_cache.retain == 0)
+		isl_blk_trim_cache(ctx);
+	return isl_stat_ok;
+}
+
 void isl_ctx_ref(struct isl_ctx *ctx)
 {
 	ctx->ref++;
@@ -290,35 +441,110 @@ void isl_ctx_deref(struct isl_ctx *ctx)
 	ctx->ref--;
 }
 
+/* The fields of struct isl_stats, in the order in which they are printed,
+ * as described by ISL_STATS_FIELDS.
+ * "stat" is the corresponding isl_ctx_stat value,
+ * "name" is the name of the field in the JSON representation,
+ * "desc" is the description printed by the --print-stats option and
+ * "offset" is the offset of the field inside struct isl_stats.
+ * If "clock" is set, then the field keeps track of processor time
+ * (in clock ticks) and it is printed in seconds.
+ */
+static struct {
+	enum isl_ctx_stat stat;
+	const char *name;
+	const char *desc;
+	size_t offset;
+	int clock;
+} stats_fields[] = {
+#define ISL_STATS_FIELD(field, desc, clock)				\
+	{ isl_ctx_stat_ ## field, #field, desc,				\
+	  offsetof(struct isl_stats, field), clock },
+	ISL_STATS_FIELDS
+#undef ISL_STATS_FIELD
+};
+
+/* Return the value of the field of "stats" described by stats_fields[i].
+ */
+static long stats_field(struct isl_stats *stats, int i)
+{
+	return *(long *) ((char *) stats + stats_fields[i].offset);
+}
+
+/* Return the processor time used so far, for updating
+ * the processor time fields of the statistics of "ctx".
+ * The processor time is only measured if the stats_clock option is set.
+ * Otherwise, 0 is returned such that these fields remain zero.
+ */
+clock_t isl_ctx_clock(isl_ctx *ctx)
+{
+	if (!ctx->opt->stats_clock)
+		return 0;
+	return clock();
+}
+
 /* Print statistics on usage.
  */
 static void print_stats(isl_ctx *ctx)
 {
+	int i;
+
 	fprintf(stderr, "operations: %lu\n", ctx->operations);
+	for (i = 0; i < ARRAY_SIZE(stats_fields); ++i) {
+		long v = stats_field(ctx->stats, i);
+
+		if (stats_fields[i].clock)
+			fprintf(stderr, "%s: %.3f s\n", stats_fields[i].desc,
+				(double) v / CLOCKS_PER_SEC);
+		else
+			fprintf(stderr, "%s: %ld\n", stats_fields[i].desc, v);
+	}
 }
 
+/* Free "ctx".
+ *
+ * The identifiers in a frozen context are only freed
+ * together with the context, so they are not considered
+ * to be outstanding references to the context.
+ * A child context does not own the options and
+ * releases its reference to its parent.
+ */
 void isl_ctx_free(struct isl_ctx *ctx)
 {
+	int ref;
+
 	if (!ctx)
 		return;
-	if (ctx->ref != 0)
+	isl_basic_map_cache_free(ctx);
+	ref = ctx->ref;
+	if (ctx->frozen)
+		ref -= ctx->id_table.n;
+	if (ref != 0)
 		isl_die(ctx, isl_error_invalid,
 			"isl_ctx not freed as some objects still reference it",
 			return);
 
+	isl_ctx_set_trace_callback(ctx, NULL, NULL, NULL);
 	if (ctx->opt->print_stats)
 		print_stats(ctx);
 
+	if (ctx->frozen)
+		isl_id_table_free_frozen(ctx);
 	isl_hash_table_clear(&ctx->id_table);
+	isl_hash_table_free(ctx, ctx->space_table);
 	isl_blk_clear_cache(ctx);
 	isl_int_clear(ctx->zero);
 	isl_int_clear(ctx->one);
 	isl_int_clear(ctx->two);
 	isl_int_clear(ctx->negone);
 	isl_int_clear(ctx->normalize_gcd);
-	isl_args_free(ctx->user_args, ctx->user_opt);
-	if (ctx->opt_allocated)
-		isl_options_free(ctx->opt);
+	if (ctx->parent) {
+		isl_ctx_deref(ctx->parent);
+	} else {
+		isl_args_free(ctx->user_args, ctx->user_opt);
+		if (ctx->opt_allocated)
+			isl_options_free(ctx->opt);
+	}
 	free(ctx->stats);
 	free(ctx);
 }
@@ -419,3 +645,172 @@ void isl_ctx_reset_operations(isl_ctx *ctx)
 		return;
 	ctx->operations = 0;
 }
+
+/* Return the value of the statistic "stat" collected by "ctx",
+ * or -1 on error.
+ */
+long isl_ctx_get_stat(isl_ctx *ctx, enum isl_ctx_stat stat)
+{
+	int i;
+
+	if (!ctx)
+		return -1;
+	for (i = 0; i < ARRAY_SIZE(stats_fields); ++i)
+		if (stats_fields[i].stat == stat)
+			return stats_field(ctx->stats, i);
+	isl_die(ctx, isl_error_invalid, "unknown statistic", return -1);
+}
+
+/* Reset the statistics collected by "ctx".
+ */
+void isl_ctx_reset_stats(isl_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	memset(ctx->stats, 0, sizeof(*ctx->stats));
+}
+
+/* Return a JSON representation of the statistics collected by "ctx",
+ * along with the number of operations performed by "ctx".
+ * Processor times are expressed in seconds.
+ */
+__isl_give char *isl_ctx_stats_to_json(isl_ctx *ctx)
+{
+	int i;
+	char buf[100];
+	isl_printer *p;
+	char *str;
+
+	if (!ctx)
+		return NULL;
+
+	p = isl_printer_to_str(ctx);
+	snprintf(buf, sizeof(buf), "{ \"operations\": %lu", ctx->operations);
+	p = isl_printer_print_str(p, buf);
+	for (i = 0; i < ARRAY_SIZE(stats_fields); ++i) {
+		long v = stats_field(ctx->stats, i);
+
+		if (stats_fields[i].clock)
+			snprintf(buf, sizeof(buf), ", \"%s\": %.6f",
+				stats_fields[i].name,
+				(double) v / CLOCKS_PER_SEC);
+		else
+			snprintf(buf, sizeof(buf), ", \"%s\": %ld",
+				stats_fields[i].name, v);
+		p = isl_printer_print_str(p, buf);
+	}
+	p = isl_printer_print_str(p, " }");
+	str = isl_printer_get_str(p);
+	isl_printer_free(p);
+
+	return str;
+}
+
+/* Install "fn" as the trace callback of "ctx", replacing
+ * any previously installed callback.
+ * "fn" is called with event isl_trace_begin on entry to
+ * some of the top-level operations and with event isl_trace_end
+ * on exit, along with the name of the operation and the size
+ * of its input.  The calls are properly nested.
+ * If "free_user" is not NULL, then it is called on "user"
+ * when the callback is replaced or when "ctx" is freed.
+ * Passing a NULL "fn" removes the current callback.
+ */
+isl_stat isl_ctx_set_trace_callback(isl_ctx *ctx,
+	void (*fn)(isl_ctx *ctx, enum isl_trace_event event,
+		const char *name, int size, void *user),
+	void *user, void (*free_user)(void *user))
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->trace_free_user)
+		ctx->trace_free_user(ctx->trace_user);
+	ctx->trace = fn;
+	ctx->trace_user = fn ? user : NULL;
+	ctx->trace_free_user = fn ? free_user : NULL;
+	return isl_stat_ok;
+}
+
+/* Report the start of the operation "name" on an input of size "size"
+ * to the trace callback of "ctx", if any.
+ */
+void isl_ctx_trace_begin(isl_ctx *ctx, const char *name, int size)
+{
+	if (!ctx || !ctx->trace)
+		return;
+	ctx->trace(ctx, isl_trace_begin, name, size, ctx->trace_user);
+}
+
+/* Report the end of the operation "name" on an input of size "size"
+ * to the trace callback of "ctx", if any.
+ */
+void isl_ctx_trace_end(isl_ctx *ctx, const char *name, int size)
+{
+	if (!ctx || !ctx->trace)
+		return;
+	ctx->trace(ctx, isl_trace_end, name, size, ctx->trace_user);
+}
+
+/* State of the trace callback installed by isl_ctx_trace_to_chrome_file.
+ *
+ * "out" is the file to which the events are written.
+ * "n" is the number of events written so far.
+ */
+struct isl_chrome_trace {
+	FILE *out;
+	int n;
+};
+
+/* Write "event" of the operation "name" to data->out
+ * as an element of a JSON array in the Chrome trace event format.
+ * The time stamps are expressed in microseconds of processor time.
+ */
+static void chrome_trace(isl_ctx *ctx, enum isl_trace_event event,
+	const char *name, int size, void *user)
+{
+	struct isl_chrome_trace *data = user;
+	double ts = (double) clock() * 1e6 / CLOCKS_PER_SEC;
+
+	fprintf(data->out, "%s\n{ \"name\": \"%s\", \"ph\": \"%s\", "
+		"\"ts\": %.0f, \"pid\": 1, \"tid\": 1, "
+		"\"args\": { \"size\": %d } }",
+		data->n ? "," : "", name,
+		event == isl_trace_begin ? "B" : "E", ts, size);
+	data->n++;
+}
+
+/* Close the JSON array written by chrome_trace and free "user".
+ */
+static void chrome_trace_free(void *user)
+{
+	struct isl_chrome_trace *data = user;
+
+	fprintf(data->out, "\n]\n");
+	fflush(data->out);
+	free(data);
+}
+
+/* Install a trace callback on "ctx" that writes the trace events
+ * to "out" in the Chrome trace event format, which can be loaded
+ * in chrome://tracing or Perfetto.
+ * The JSON array is closed when the callback is replaced or
+ * when "ctx" is freed.  "out" is not closed by isl.
+ */
+isl_stat isl_ctx_trace_to_chrome_file(isl_ctx *ctx, FILE *out)
+{
+	struct isl_chrome_trace *data;
+
+	if (!ctx)
+		return isl_stat_error;
+	if (!out)
+		isl_die(ctx, isl_error_invalid, "no output file",
+			return isl_stat_error);
+	data = isl_alloc_type(ctx, struct isl_chrome_trace);
+	if (!data)
+		return isl_stat_error;
+	data->out = out;
+	data->n = 0;
+	fprintf(out, "[");
+	return isl_ctx_set_trace_callback(ctx, &chrome_trace, data,
+					&chrome_trace_free);
+}
@@ -1,16 +1,81 @@
+#include <time.h>
 #include <isl/ctx.h>
 #include <isl_blk.h>
 
+/* The statistics kept by an isl_ctx, in the order in which they are printed.
+ * Each entry consists of the name of the field in struct isl_stats,
+ * which is also the name of the corresponding isl_ctx_stat value
+ * (without the isl_ctx_stat_ prefix) and the name used
+ * in the JSON representation, a description printed
+ * by the --print-stats option and a flag that is set
+ * if the field keeps track of processor time (in clock ticks).
+ * struct isl_stats and the table of statistics in isl_ctx.c
+ * are both derived from this list, such that they cannot get out of sync.
+ */
+#define ISL_STATS_FIELDS						\
+	ISL_STATS_FIELD(gbr_solved_lps,					\
+		"generalized basis reduction LP problems", 0)		\
+	ISL_STATS_FIELD(blk_alloc, "block allocations", 0)		\
+	ISL_STATS_FIELD(blk_cache_hit, "block cache hits", 0)		\
+	ISL_STATS_FIELD(blk_malloc, "block system allocations", 0)	\
+	ISL_STATS_FIELD(space_interned, "interned spaces", 0)		\
+	ISL_STATS_FIELD(basic_map_cache_hit, "basic map cache hits", 0)	\
+	ISL_STATS_FIELD(basic_map_cache_miss,				\
+		"basic map cache misses", 0)				\
+	ISL_STATS_FIELD(subtract_pairs, "subtraction pairs", 0)		\
+	ISL_STATS_FIELD(subtract_pruned_pairs,				\
+		"subtraction pairs pruned", 0)				\
+	ISL_STATS_FIELD(tab_alloc, "tableau allocations", 0)		\
+	ISL_STATS_FIELD(tab_pivots, "tableau pivots", 0)		\
+	ISL_STATS_FIELD(tab_float_guided,				\
+		"floating point guided optimizations", 0)		\
+	ISL_STATS_FIELD(pip_splits,					\
+		"parametric integer programming splits", 0)		\
+	ISL_STATS_FIELD(pip_max_level,					\
+		"parametric integer programming maximal depth", 0)	\
+	ISL_STATS_FIELD(coalesce_pairs, "coalescing pairs", 0)		\
+	ISL_STATS_FIELD(coalesce_clock, "coalescing time", 1)		\
+	ISL_STATS_FIELD(farkas, "Farkas constructions", 0)		\
+	ISL_STATS_FIELD(farkas_clock, "Farkas construction time", 1)	\
+	ISL_STATS_FIELD(sched_lp, "scheduler LP problems", 0)		\
+	ISL_STATS_FIELD(sched_lp_clock, "scheduler LP time", 1)		\
+	ISL_STATS_FIELD(sched_fallback, "scheduler budget fallbacks", 0)	\
+	ISL_STATS_FIELD(ast_build, "AST generations", 0)		\
+	ISL_STATS_FIELD(ast_build_clock, "AST generation time", 1)
+
+struct isl_stats {
+#define ISL_STATS_FIELD(field, desc, clock)	long field;
+	ISL_STATS_FIELDS
+#undef ISL_STATS_FIELD
+};
+
 /* "error" stores the last error that has occurred.
  * It is reset to isl_error_none by isl_ctx_reset_error.
  * "error_msg" stores the error message of the last error,
  * while "error_file" and "error_line" specify where the last error occurred.
  * "error_msg" and "error_file" always point to statically allocated
  * strings (if not NULL).
+ *
+ * If "frozen" is set, then the context has been frozen by isl_ctx_freeze and
+ * may be shared by several threads, each using its own child context.
+ * Its options, identifiers and constants are then treated as read-only.
+ * "parent" is set (only) for a child context allocated
+ * by isl_ctx_alloc_child and refers to the frozen context
+ * whose options and identifiers it shares.
+ *
+ * "bmap_cache" holds the results of operations on basic maps
+ * (see isl_basic_map_cache.c), if any.
+ *
+ * "n_cache_tmp" is the number of temporary files created
+ * by the schedule cache (see isl_schedule_cache.c) on systems
+ * without mkstemp.  It is used to make the names of these files unique.
  */
 struct isl_ctx {
 	int			ref;
 
+	int			frozen;
+	struct isl_ctx		*parent;
+
 	struct isl_stats	*stats;
 
 	int			 opt_allocated;
@@ -25,10 +90,11 @@ struct isl_ctx {
 
 	isl_int			normalize_gcd;
 
-	int			n_cached;
-	int			n_miss;
-	struct isl_blk		cache[ISL_BLK_CACHE_SIZE];
+	struct isl_blk_cache	blk_cache;
 	struct isl_hash_table	id_table;
+	struct isl_hash_table	*space_table;
+	struct isl_basic_map_cache	*bmap_cache;
+	unsigned long		n_cache_tmp;
 
 	enum isl_error		error;
 	const char		*error_msg;
@@ -39,9 +105,19 @@ struct isl_ctx {
 
 	unsigned long		operations;
 	unsigned long		max_operations;
+
+	void			(*trace)(isl_ctx *ctx,
+					enum isl_trace_event event,
+					const char *name, int size, void *user);
+	void			*trace_user;
+	void			(*trace_free_user)(void *user);
 };
 
 int isl_ctx_next_operation(isl_ctx *ctx);
+clock_t isl_ctx_clock(isl_ctx *ctx);
+
+void isl_ctx_trace_begin(isl_ctx *ctx, const char *name, int size);
+void isl_ctx_trace_end(isl_ctx *ctx, const char *name, int size);
 
 void isl_ctx_set_full_error(isl_ctx *ctx, enum isl_error error, const char *msg,
 	const char *file, int line);
@@ -8,6 +8,8 @@
  * 91893 Orsay, France 
  */
 
+#include <time.h>
+#include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl/set.h>
 #include <isl_space_private.h>
@@ -839,7 +841,9 @@ static __isl_give isl_basic_set *basic_set_coefficients(
 __isl_give isl_basic_set *isl_basic_set_coefficients(
 	__isl_take isl_basic_set *bset)
 {
+	isl_ctx *ctx;
 	isl_space *space;
+	clock_t start;
 
 	if (!bset)
 		return NULL;
@@ -848,11 +852,15 @@ __isl_give isl_basic_set *isl_basic_set_coefficients(
 			"input set not allowed to have local variables",
 			goto error);
 
+	ctx = isl_basic_set_get_ctx(bset);
+	ctx->stats->farkas++;
+	start = isl_ctx_clock(ctx);
 	space = isl_basic_set_get_space(bset);
 	space = isl_space_coefficients(space);
 
 	bset = basic_set_coefficients(bset);
 	bset = isl_basic_set_reset_space(bset, space);
+	ctx->stats->farkas_clock += isl_ctx_clock(ctx) - start;
 	return bset;
 error:
 	isl_basic_set_free(bset);
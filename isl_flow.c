@@ -16,6 +16,7 @@
  * and Ecole Normale Superieure, 45 rue d'Ulm, 75230 Paris, France
  */
 
+#include <isl_ctx_private.h>
 #include <isl/val.h>
 #include <isl/space.h>
 #include <isl/set.h>
@@ -3203,7 +3204,7 @@ error:
  * or a schedule map and call the corresponding function to perform
  * the analysis.
  */
-__isl_give isl_union_flow *isl_union_access_info_compute_flow(
+static __isl_give isl_union_flow *union_access_info_compute_flow(
 	__isl_take isl_union_access_info *access)
 {
 	isl_bool has_kill;
@@ -3235,6 +3236,27 @@ error:
 	return NULL;
 }
 
+/* Perform the dataflow analysis described by "access",
+ * reporting the analysis to the trace callback of the isl_ctx, if any,
+ * along with the number of sink accesses.
+ */
+__isl_give isl_union_flow *isl_union_access_info_compute_flow(
+	__isl_take isl_union_access_info *access)
+{
+	isl_ctx *ctx;
+	isl_size n;
+	isl_union_flow *flow;
+
+	if (!access)
+		return NULL;
+	ctx = isl_union_access_info_get_ctx(access);
+	n = isl_union_map_n_map(access->access[isl_access_sink]);
+	isl_ctx_trace_begin(ctx, "isl_union_access_info_compute_flow", n);
+	flow = union_access_info_compute_flow(access);
+	isl_ctx_trace_end(ctx, "isl_union_access_info_compute_flow", n);
+	return flow;
+}
+
 /* Print the information contained in "flow" to "p".
  * The information is printed as a YAML document.
  */
@@ -97,6 +97,13 @@ static isl_bool isl_id_has_name_and_user(const void *entry, const void *val)
 	return isl_bool_ok(!strcmp(id->name, nu->name));
 }
 
+/* Return an isl_id with the given name and user pointer.
+ *
+ * If "ctx" is a child context, then first look for the identifier
+ * in the (frozen) parent such that identifiers created
+ * before the parent was frozen are shared by all children.
+ * No new identifiers can be created in a frozen context.
+ */
 __isl_give isl_id *isl_id_alloc(isl_ctx *ctx, const char *name, void *user)
 {
 	struct isl_hash_table_entry *entry;
@@ -111,8 +118,22 @@ __isl_give isl_id *isl_id_alloc(isl_ctx *ctx, const char *name, void *user)
 		id_hash = isl_hash_string(id_hash, name);
 	else
 		id_hash = isl_hash_builtin(id_hash, user);
+	if (ctx->parent) {
+		isl_ctx *parent = ctx->parent;
+
+		entry = isl_hash_table_find(parent, &parent->id_table, id_hash,
+					isl_id_has_name_and_user, &nu, 0);
+		if (!entry)
+			return NULL;
+		if (entry != isl_hash_table_entry_none)
+			return entry->data;
+	}
 	entry = isl_hash_table_find(ctx, &ctx->id_table, id_hash,
-					isl_id_has_name_and_user, &nu, 1);
+				isl_id_has_name_and_user, &nu, !ctx->frozen);
+	if (entry == isl_hash_table_entry_none)
+		isl_die(ctx, isl_error_invalid,
+			"cannot create identifier in frozen context",
+			return NULL);
 	if (!entry)
 		return NULL;
 	if (entry->data)
@@ -125,13 +146,15 @@ __isl_give isl_id *isl_id_alloc(isl_ctx *ctx, const char *name, void *user)
 
 /* If the id has a negative refcount, then it is a static isl_id
  * which should not be changed.
+ * Similarly, the refcount of an id in a frozen context is not updated
+ * since such an id may be shared by several threads.
  */
 __isl_give isl_id *isl_id_copy(isl_id *id)
 {
 	if (!id)
 		return NULL;
 
-	if (id->ref < 0)
+	if (id->ref < 0 || id->ctx->frozen)
 		return id;
 
 	id->ref++;
@@ -201,8 +224,22 @@ void (*isl_id_get_free_user(__isl_keep isl_id *id))(void *user)
 	return id->free_user;
 }
 
+/* Free the memory associated to "id", without removing it
+ * from the identifier table of its context.
+ */
+static void id_free(__isl_take isl_id *id)
+{
+	if (id->free_user)
+		id->free_user(id->user);
+
+	free((char *)id->name);
+	isl_ctx_deref(id->ctx);
+	free(id);
+}
+
 /* If the id has a negative refcount, then it is a static isl_id
  * and should not be freed.
+ * An id in a frozen context is only freed by isl_id_table_free_frozen.
  */
 __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 {
@@ -211,7 +248,7 @@ __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 	if (!id)
 		return NULL;
 
-	if (id->ref < 0)
+	if (id->ref < 0 || id->ctx->frozen)
 		return NULL;
 
 	if (--id->ref > 0)
@@ -227,16 +264,31 @@ __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 	else
 		isl_hash_table_remove(id->ctx, &id->ctx->id_table, entry);
 
-	if (id->free_user)
-		id->free_user(id->user);
-
-	free((char *)id->name);
-	isl_ctx_deref(id->ctx);
-	free(id);
+	id_free(id);
 
 	return NULL;
 }
 
+/* Free the isl_id stored in "entry".
+ */
+static isl_stat free_entry(void **entry, void *user)
+{
+	id_free(*entry);
+	*entry = NULL;
+
+	return isl_stat_ok;
+}
+
+/* Free all identifiers in the frozen context "ctx",
+ * irrespective of their reference counts.
+ * This function is only called when "ctx" itself is being freed.
+ */
+void isl_id_table_free_frozen(isl_ctx *ctx)
+{
+	isl_hash_table_foreach(ctx, &ctx->id_table, &free_entry, NULL);
+	ctx->id_table.n = 0;
+}
+
 __isl_give isl_printer *isl_printer_print_id(__isl_take isl_printer *p,
 	__isl_keep isl_id *id)
 {
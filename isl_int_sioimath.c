@@ -5,13 +5,14 @@
 
 extern int isl_sioimath_decode(isl_sioimath val, int32_t *small, mp_int *big);
 extern int isl_sioimath_decode_big(isl_sioimath val, mp_int *big);
-extern int isl_sioimath_decode_small(isl_sioimath val, int32_t *small);
+extern int isl_sioimath_decode_small(isl_sioimath val,
+	isl_sioimath_small *small);
 
-extern isl_sioimath isl_sioimath_encode_small(int32_t val);
+extern isl_sioimath isl_sioimath_encode_small(isl_sioimath_small val);
 extern isl_sioimath isl_sioimath_encode_big(mp_int val);
 extern int isl_sioimath_is_small(isl_sioimath val);
 extern int isl_sioimath_is_big(isl_sioimath val);
-extern int32_t isl_sioimath_get_small(isl_sioimath val);
+extern isl_sioimath_small isl_sioimath_get_small(isl_sioimath val);
 extern mp_int isl_sioimath_get_big(isl_sioimath val);
 
 extern void isl_siomath_uint32_to_digits(uint32_t num, mp_digit *digits,
@@ -30,9 +31,15 @@ extern mp_int isl_sioimath_si64arg_src(int64_t arg,
 extern mp_int isl_sioimath_uiarg_src(unsigned long arg,
 	isl_sioimath_scratchspace_t *scratch);
 extern mp_int isl_sioimath_reinit_big(isl_sioimath_ptr ptr);
-extern void isl_sioimath_set_small(isl_sioimath_ptr ptr, int32_t val);
+extern void isl_sioimath_set_small(isl_sioimath_ptr ptr,
+	isl_sioimath_small val);
 extern void isl_sioimath_set_int32(isl_sioimath_ptr ptr, int32_t val);
 extern void isl_sioimath_set_int64(isl_sioimath_ptr ptr, int64_t val);
+#ifdef ISL_SIOIMATH_SMALL_64
+extern int isl_sioimath_mul_overflow(int64_t lhs, int64_t rhs, int64_t *prod);
+#endif
+extern void isl_sioimath_set_product(isl_sioimath_ptr ptr, int64_t lhs,
+	int64_t rhs);
 extern void isl_sioimath_promote(isl_sioimath_ptr dst);
 extern void isl_sioimath_try_demote(isl_sioimath_ptr dst);
 
@@ -81,12 +88,13 @@ extern void isl_sioimath_submul_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 /* Implements the Euclidean algorithm to compute the greatest common divisor of
  * two values in small representation.
  */
-static uint32_t isl_sioimath_smallgcd(int32_t lhs, int32_t rhs)
+isl_sioimath_usmall isl_sioimath_smallgcd(isl_sioimath_small lhs,
+	isl_sioimath_small rhs)
 {
-	uint32_t dividend, divisor, remainder;
+	isl_sioimath_usmall dividend, divisor, remainder;
 
-	dividend = labs(lhs);
-	divisor = labs(rhs);
+	dividend = lhs < 0 ? -lhs : lhs;
+	divisor = rhs < 0 ? -rhs : rhs;
 	while (divisor) {
 		remainder = dividend % divisor;
 		dividend = divisor;
@@ -103,8 +111,8 @@ static uint32_t isl_sioimath_smallgcd(int32_t lhs, int32_t rhs)
 void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
-	uint32_t smallgcd;
+	isl_sioimath_small lhssmall, rhssmall;
+	isl_sioimath_usmall smallgcd;
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
@@ -121,13 +129,15 @@ void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 }
 
 /* Compute the lowest common multiple of two numbers.
+ *
+ * If both numbers are in small representation, then the result
+ * is computed as |lhs| / gcd(lhs, rhs) * |rhs|.
  */
 void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
-	uint32_t smallgcd;
-	uint64_t multiple;
+	isl_sioimath_small lhssmall, rhssmall;
+	isl_sioimath_usmall smallgcd;
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
@@ -137,8 +147,12 @@ void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 			return;
 		}
 		smallgcd = isl_sioimath_smallgcd(lhssmall, rhssmall);
-		multiple = (uint64_t) abs(lhssmall) * (uint64_t) abs(rhssmall);
-		isl_sioimath_set_int64(dst, multiple / smallgcd);
+		if (lhssmall < 0)
+			lhssmall = -lhssmall;
+		if (rhssmall < 0)
+			rhssmall = -rhssmall;
+		isl_sioimath_set_product(dst,
+		    (isl_sioimath_usmall) lhssmall / smallgcd, rhssmall);
 		return;
 	}
 
@@ -165,13 +179,19 @@ extern void isl_sioimath_fdiv_r(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 
 /* Parse a number from a string.
  * If it has less than 10 characters then it will fit into the small
- * representation (i.e. strlen("2147483647")). Otherwise, let IMath parse it.
+ * representation (i.e. strlen("2147483647")).  With the 64 bit small
+ * representation, this holds for less than 19 characters
+ * (i.e. strlen("4611686018427387903")).  Otherwise, let IMath parse it.
  */
 void isl_sioimath_read(isl_sioimath_ptr dst, const char *str)
 {
-	int32_t small;
+	isl_sioimath_small small;
 
+#ifdef ISL_SIOIMATH_SMALL_64
+	if (strlen(str) < 19) {
+#else
 	if (strlen(str) < 10) {
+#endif
 		small = strtol(str, NULL, 10);
 		isl_sioimath_set_small(dst, small);
 		return;
@@ -198,12 +218,16 @@ extern void isl_sioimath_print(FILE *out, isl_sioimath_src i, int width);
 void isl_sioimath_print(FILE *out, isl_sioimath_src i, int width)
 {
 	size_t len;
-	int32_t small;
+	isl_sioimath_small small;
 	mp_int big;
 	char *buf;
 
 	if (isl_sioimath_decode_small(i, &small)) {
+#ifdef ISL_SIOIMATH_SMALL_64
+		fprintf(out, "%*" PRIi64, width, small);
+#else
 		fprintf(out, "%*" PRIi32, width, small);
+#endif
 		return;
 	}
 
@@ -55,15 +55,30 @@
  * On 32 bit machines isl_sioimath type is blown up to 8 bytes, i.e.
  * isl_sioimath is guaranteed to be at least 8 bytes. This is to ensure the
  * int32_t can be hidden in that type without data loss. In the future we might
- * optimize this to use 31 hidden bits in a 32 bit pointer. We may also use 63
- * bits on 64 bit machines, but this comes with the cost of additional overflow
- * checks because there is no standardized 128 bit integer we could expand to.
+ * optimize this to use 31 hidden bits in a 32 bit pointer.
+ *
+ * If USE_SMALL_INT_64 is defined (--with-int=imath-64), then all 63 bits
+ * above the discriminator bit are used for an int64_t instead:
+ *
+ * Small representation (64 bit):
+ * MSB                                                          LSB
+ * |---------------------------------------------------------------1
+ * |                          int64_t                             |
+ * |        4611686018427387903 ... -4611686018427387903          |
+ *
+ * The sum or difference of two such numbers still fits in an int64_t,
+ * but products need to be checked for overflow since there is
+ * no standardized 128 bit integer we could expand to.
+ * The 64 bit small representation is only used if a long can represent
+ * any int64_t, such that the IMath functions taking an mp_small
+ * can be applied to any number in small representation.
+ * Otherwise, the 32 bit small representation is used.
  *
  * We use native integer types and avoid union structures to avoid assumptions
  * on the machine's endianness.
  *
  * This implementation makes the following assumptions:
- * - long can represent any int32_t
+ * - long can represent any isl_sioimath_small
  * - mp_small is signed long
  * - mp_usmall is unsigned long
  * - adresses returned by malloc are aligned to 2-byte boundaries (leastmost
@@ -75,6 +90,21 @@ typedef uint64_t isl_sioimath;
 typedef uintptr_t isl_sioimath;
 #endif
 
+#if defined(USE_SMALL_INT_64) && LONG_MAX >= INT64_MAX
+#define ISL_SIOIMATH_SMALL_64
+#endif
+
+/* The type of a number in small representation and
+ * the corresponding unsigned type.
+ */
+#ifdef ISL_SIOIMATH_SMALL_64
+typedef int64_t isl_sioimath_small;
+typedef uint64_t isl_sioimath_usmall;
+#else
+typedef int32_t isl_sioimath_small;
+typedef uint32_t isl_sioimath_usmall;
+#endif
+
 /* The negation of the smallest possible number in int32_t, INT32_MIN
  * (0x80000000u, -2147483648), cannot be represented in an int32_t, therefore
  * every operation that may produce this value needs to special-case it.
@@ -85,11 +115,39 @@ typedef uintptr_t isl_sioimath;
  * INT32_MIN/-1 (any division: divexact, fdiv, cdiv, tdiv)
  * To avoid checking these cases, we exclude INT32_MIN from small
  * representation.
+ * Similarly, the 64 bit small representation is restricted
+ * to a range that is symmetric around zero.
  */
+#ifdef ISL_SIOIMATH_SMALL_64
+#define ISL_SIOIMATH_SMALL_MIN (-(INT64_MAX >> 1))
+#else
 #define ISL_SIOIMATH_SMALL_MIN (-INT32_MAX)
+#endif
 
 /* Largest possible number in small representation */
+#ifdef ISL_SIOIMATH_SMALL_64
+#define ISL_SIOIMATH_SMALL_MAX (INT64_MAX >> 1)
+#else
 #define ISL_SIOIMATH_SMALL_MAX INT32_MAX
+#endif
+
+/* Largest absolute value of a (signed or unsigned) long that
+ * may be multiplied with a number in small representation
+ * in isl_sioimath_set_product and the largest shift
+ * that may be applied in isl_sioimath_mul_2exp without falling back
+ * to big representation.
+ * With the 32 bit small representation, the product is guaranteed
+ * to fit in an int64_t.
+ * With the 64 bit small representation, isl_sioimath_set_product checks
+ * for overflow.
+ */
+#ifdef ISL_SIOIMATH_SMALL_64
+#define ISL_SIOIMATH_FACTOR_MAX INT64_MAX
+#define ISL_SIOIMATH_SHIFT_MAX 62ul
+#else
+#define ISL_SIOIMATH_FACTOR_MAX UINT32_MAX
+#define ISL_SIOIMATH_SHIFT_MAX 32ul
+#endif
 
 /* Used for function parameters the function modifies. */
 typedef isl_sioimath *isl_sioimath_ptr;
@@ -114,9 +172,13 @@ inline int isl_sioimath_is_big(isl_sioimath val)
 /* Get the number of an isl_int in small representation. Result is undefined if
  * val is not stored in that format.
  */
-inline int32_t isl_sioimath_get_small(isl_sioimath val)
+inline isl_sioimath_small isl_sioimath_get_small(isl_sioimath val)
 {
+#ifdef ISL_SIOIMATH_SMALL_64
+	return ((int64_t) val) >> 1;
+#else
 	return val >> 32;
+#endif
 }
 
 /* Get the number of an in isl_int in big representation. Result is undefined if
@@ -133,7 +195,8 @@ inline mp_int isl_sioimath_get_big(isl_sioimath val)
  * representation. If there is no such branch, then a single shift is still
  * cheaper than introducing branching code.
  */
-inline int isl_sioimath_decode_small(isl_sioimath val, int32_t *small)
+inline int isl_sioimath_decode_small(isl_sioimath val,
+	isl_sioimath_small *small)
 {
 	*small = isl_sioimath_get_small(val);
 	return isl_sioimath_is_small(val);
@@ -149,9 +212,13 @@ inline int isl_sioimath_decode_big(isl_sioimath val, mp_int *big)
 
 /* Encode a small representation into an isl_int.
  */
-inline isl_sioimath isl_sioimath_encode_small(int32_t val)
+inline isl_sioimath isl_sioimath_encode_small(isl_sioimath_small val)
 {
+#ifdef ISL_SIOIMATH_SMALL_64
+	return ((isl_sioimath) val) << 1 | 0x00000001;
+#else
 	return ((isl_sioimath) val) << 32 | 0x00000001;
+#endif
 }
 
 /* Encode a big representation.
@@ -248,8 +315,8 @@ inline mp_int isl_sioimath_bigarg_src(isl_sioimath arg,
 	isl_sioimath_scratchspace_t *scratch)
 {
 	mp_int big;
-	int32_t small;
-	uint32_t num;
+	isl_sioimath_small small;
+	isl_sioimath_usmall num;
 
 	if (isl_sioimath_decode_big(arg, &big))
 		return big;
@@ -265,7 +332,7 @@ inline mp_int isl_sioimath_bigarg_src(isl_sioimath arg,
 		num = -small;
 	}
 
-	isl_siomath_uint32_to_digits(num, scratch->digits, &scratch->big.used);
+	ISL_SIOIMATH_TO_DIGITS(num, scratch->digits, scratch->big.used);
 	return &scratch->big;
 }
 
@@ -337,7 +404,8 @@ inline mp_int isl_sioimath_reinit_big(isl_sioimath_ptr ptr)
 
 /* Set ptr to a number in small representation.
  */
-inline void isl_sioimath_set_small(isl_sioimath_ptr ptr, int32_t val)
+inline void isl_sioimath_set_small(isl_sioimath_ptr ptr,
+	isl_sioimath_small val)
 {
 	if (isl_sioimath_is_big(*ptr))
 		mp_int_free(isl_sioimath_get_big(*ptr));
@@ -370,11 +438,61 @@ inline void isl_sioimath_set_int64(isl_sioimath_ptr ptr, int64_t val)
 	    isl_sioimath_reinit_big(ptr));
 }
 
+#ifdef ISL_SIOIMATH_SMALL_64
+/* Store the product of "lhs" and "rhs" in "prod" and
+ * return whether this product overflows an int64_t.
+ * Neither argument may be INT64_MIN.
+ */
+inline int isl_sioimath_mul_overflow(int64_t lhs, int64_t rhs, int64_t *prod)
+{
+#if (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__)
+	return __builtin_mul_overflow(lhs, rhs, prod);
+#else
+	uint64_t abslhs, absrhs;
+
+	abslhs = lhs < 0 ? -lhs : lhs;
+	absrhs = rhs < 0 ? -rhs : rhs;
+	if (abslhs != 0 && absrhs > (uint64_t) INT64_MAX / abslhs)
+		return 1;
+	*prod = lhs * rhs;
+	return 0;
+#endif
+}
+#endif
+
+/* Assign the product of two int64_t numbers,
+ * using small representation if possible.
+ *
+ * With the 32 bit small representation, the callers ensure that
+ * the product fits in an int64_t.  With the 64 bit small representation,
+ * the product is computed by IMath if it overflows.
+ * Neither argument may be INT64_MIN.
+ */
+inline void isl_sioimath_set_product(isl_sioimath_ptr ptr, int64_t lhs,
+	int64_t rhs)
+{
+#ifdef ISL_SIOIMATH_SMALL_64
+	int64_t prod;
+	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
+
+	if (!isl_sioimath_mul_overflow(lhs, rhs, &prod)) {
+		isl_sioimath_set_int64(ptr, prod);
+		return;
+	}
+
+	mp_int_mul(isl_sioimath_si64arg_src(lhs, &lhsscratch),
+	    isl_sioimath_si64arg_src(rhs, &rhsscratch),
+	    isl_sioimath_reinit_big(ptr));
+#else
+	isl_sioimath_set_int64(ptr, lhs * rhs);
+#endif
+}
+
 /* Convert to big representation while preserving the current number.
  */
 inline void isl_sioimath_promote(isl_sioimath_ptr dst)
 {
-	int32_t small;
+	isl_sioimath_small small;
 
 	if (isl_sioimath_is_big(*dst))
 		return;
@@ -530,15 +648,21 @@ inline double isl_sioimath_get_d(isl_sioimath_src val)
 /* Format a number as decimal string.
  *
  * The largest possible string from small representation is 12 characters
- * ("-2147483647").
+ * ("-2147483647") or, with the 64 bit small representation,
+ * 21 characters ("-4611686018427387903").
  */
 inline char *isl_sioimath_get_str(isl_sioimath_src val)
 {
 	char *result;
 
 	if (isl_sioimath_is_small(val)) {
+#ifdef ISL_SIOIMATH_SMALL_64
+		result = malloc(21);
+		snprintf(result, 21, "%" PRIi64, isl_sioimath_get_small(val));
+#else
 		result = malloc(12);
 		snprintf(result, 12, "%" PRIi32, isl_sioimath_get_small(val));
+#endif
 		return result;
 	}
 
@@ -549,8 +673,10 @@ inline char *isl_sioimath_get_str(isl_sioimath_src val)
  */
 inline void isl_sioimath_abs(isl_sioimath_ptr dst, isl_sioimath_src arg)
 {
-	if (isl_sioimath_is_small(arg)) {
-		isl_sioimath_set_small(dst, labs(isl_sioimath_get_small(arg)));
+	isl_sioimath_small small;
+
+	if (isl_sioimath_decode_small(arg, &small)) {
+		isl_sioimath_set_small(dst, small < 0 ? -small : small);
 		return;
 	}
 
@@ -589,7 +715,7 @@ inline void isl_sioimath_swap(isl_sioimath_ptr lhs, isl_sioimath_ptr rhs)
 inline void isl_sioimath_add_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 	isl_sioimath_scratchspace_t lhsscratch;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
@@ -606,17 +732,17 @@ inline void isl_sioimath_add_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 /* Subtract an unsigned long.
  *
  * On LP64 unsigned long exceeds the range of an int64_t.  If
- * ISL_SIOIMATH_SMALL_MIN-rhs>=INT64_MIN we can do the calculation using int64_t
- * without risking an overflow.
+ * ISL_SIOIMATH_SMALL_MIN-rhs>=-INT64_MAX we can do the calculation using
+ * int64_t without risking an overflow.
  */
 inline void isl_sioimath_sub_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 				unsigned long rhs)
 {
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 	isl_sioimath_scratchspace_t lhsscratch;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
-	    (rhs < (uint64_t) INT64_MIN - (uint64_t) ISL_SIOIMATH_SMALL_MIN)) {
+	    (rhs <= (uint64_t) (INT64_MAX + ISL_SIOIMATH_SMALL_MIN))) {
 		isl_sioimath_set_int64(dst, (int64_t) smalllhs - rhs);
 		return;
 	}
@@ -632,7 +758,7 @@ inline void isl_sioimath_add(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small smalllhs, smallrhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
 	    isl_sioimath_decode_small(rhs, &smallrhs)) {
@@ -653,7 +779,7 @@ inline void isl_sioimath_sub(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small smalllhs, smallrhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
 	    isl_sioimath_decode_small(rhs, &smallrhs)) {
@@ -674,12 +800,11 @@ inline void isl_sioimath_mul(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small smalllhs, smallrhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
 	    isl_sioimath_decode_small(rhs, &smallrhs)) {
-		isl_sioimath_set_int64(
-		    dst, (int64_t) smalllhs * (int64_t) smallrhs);
+		isl_sioimath_set_product(dst, smalllhs, smallrhs);
 		return;
 	}
 
@@ -696,10 +821,11 @@ inline void isl_sioimath_mul_2exp(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs;
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 
-	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs <= 32ul)) {
-		isl_sioimath_set_int64(dst, ((int64_t) smalllhs) << rhs);
+	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    (rhs <= ISL_SIOIMATH_SHIFT_MAX)) {
+		isl_sioimath_set_product(dst, smalllhs, ((int64_t) 1) << rhs);
 		return;
 	}
 
@@ -713,11 +839,11 @@ inline void isl_sioimath_mul_si(isl_sioimath_ptr dst, isl_sioimath lhs,
 	signed long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs > LONG_MIN) &&
-	    (labs(rhs) <= UINT32_MAX)) {
-		isl_sioimath_set_int64(dst, (int64_t) smalllhs * (int64_t) rhs);
+	    (labs(rhs) <= ISL_SIOIMATH_FACTOR_MAX)) {
+		isl_sioimath_set_product(dst, smalllhs, rhs);
 		return;
 	}
 
@@ -733,10 +859,11 @@ inline void isl_sioimath_mul_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 
-	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs <= UINT32_MAX)) {
-		isl_sioimath_set_int64(dst, (int64_t) smalllhs * (int64_t) rhs);
+	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    (rhs <= ISL_SIOIMATH_FACTOR_MAX)) {
+		isl_sioimath_set_product(dst, smalllhs, rhs);
 		return;
 	}
 
@@ -755,7 +882,7 @@ inline void isl_sioimath_pow_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small smalllhs;
 
 	switch (rhs) {
 	case 0:
@@ -845,6 +972,8 @@ inline void isl_sioimath_submul_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_clear(&tmp);
 }
 
+isl_sioimath_usmall isl_sioimath_smallgcd(isl_sioimath_small lhs,
+	isl_sioimath_small rhs);
 void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 		      isl_sioimath_src rhs);
 void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
@@ -856,7 +985,7 @@ inline void isl_sioimath_tdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -877,11 +1006,13 @@ inline void isl_sioimath_tdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall;
+	isl_sioimath_small lhssmall;
 
-	if (isl_sioimath_is_small(lhs) && (rhs <= (unsigned long) INT32_MAX)) {
+	if (isl_sioimath_is_small(lhs) &&
+	    (rhs <= (unsigned long) ISL_SIOIMATH_SMALL_MAX)) {
 		lhssmall = isl_sioimath_get_small(lhs);
-		isl_sioimath_set_small(dst, lhssmall / (int32_t) rhs);
+		isl_sioimath_set_small(dst,
+		    lhssmall / (isl_sioimath_small) rhs);
 		return;
 	}
 
@@ -903,9 +1034,9 @@ inline void isl_sioimath_tdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 inline void isl_sioimath_cdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small lhssmall, rhssmall;
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t q;
+	isl_sioimath_small q;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -934,14 +1065,15 @@ inline void isl_sioimath_cdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, q;
+	isl_sioimath_small lhssmall, q;
 
-	if (isl_sioimath_decode_small(lhs, &lhssmall) && (rhs <= INT32_MAX)) {
+	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
+	    (rhs <= ISL_SIOIMATH_SMALL_MAX)) {
 		if (lhssmall >= 0)
 			q = ((int64_t) lhssmall + ((int64_t) rhs - 1)) /
 			    (int64_t) rhs;
 		else
-			q = lhssmall / (int32_t) rhs;
+			q = lhssmall / (isl_sioimath_small) rhs;
 		isl_sioimath_set_small(dst, q);
 		return;
 	}
@@ -958,8 +1090,8 @@ inline void isl_sioimath_fdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
-	int32_t q;
+	isl_sioimath_small lhssmall, rhssmall;
+	isl_sioimath_small q;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -988,11 +1120,12 @@ inline void isl_sioimath_fdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, q;
+	isl_sioimath_small lhssmall, q;
 
-	if (isl_sioimath_decode_small(lhs, &lhssmall) && (rhs <= INT32_MAX)) {
+	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
+	    (rhs <= ISL_SIOIMATH_SMALL_MAX)) {
 		if (lhssmall >= 0)
-			q = (uint32_t) lhssmall / rhs;
+			q = (isl_sioimath_usmall) lhssmall / rhs;
 		else
 			q = ((int64_t) lhssmall - ((int64_t) rhs - 1)) /
 			    (int64_t) rhs;
@@ -1014,7 +1147,7 @@ inline void isl_sioimath_fdiv_r(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
 	int64_t lhssmall, rhssmall;
-	int32_t r;
+	isl_sioimath_small r;
 
 	if (isl_sioimath_is_small(lhs) && isl_sioimath_is_small(rhs)) {
 		lhssmall = isl_sioimath_get_small(lhs);
@@ -1039,7 +1172,7 @@ void isl_sioimath_read(isl_sioimath_ptr dst, const char *str);
  */
 inline int isl_sioimath_sgn(isl_sioimath_src arg)
 {
-	int32_t small;
+	isl_sioimath_small small;
 
 	if (isl_sioimath_decode_small(arg, &small))
 		return (small > 0) - (small < 0);
@@ -1055,7 +1188,7 @@ inline int isl_sioimath_sgn(isl_sioimath_src arg)
 inline int isl_sioimath_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall))
@@ -1077,7 +1210,7 @@ inline int isl_sioimath_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
  */
 inline int isl_sioimath_cmp_si(isl_sioimath_src lhs, signed long rhs)
 {
-	int32_t lhssmall;
+	isl_sioimath_small lhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall))
 		return (lhssmall > rhs) - (lhssmall < rhs);
@@ -1093,12 +1226,12 @@ inline int isl_sioimath_cmp_si(isl_sioimath_src lhs, signed long rhs)
 inline int isl_sioimath_abs_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
-		lhssmall = labs(lhssmall);
-		rhssmall = labs(rhssmall);
+		lhssmall = lhssmall < 0 ? -lhssmall : lhssmall;
+		rhssmall = rhssmall < 0 ? -rhssmall : rhssmall;
 		return (lhssmall > rhssmall) - (lhssmall < rhssmall);
 	}
 
@@ -1115,7 +1248,7 @@ inline int isl_sioimath_is_divisible_by(isl_sioimath_src lhs,
 					isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small lhssmall, rhssmall;
 	mpz_t rem;
 	int cmp;
 
@@ -1144,10 +1277,10 @@ inline int isl_sioimath_is_divisible_by(isl_sioimath_src lhs,
  */
 inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
 {
-	int32_t small;
+	isl_sioimath_small small;
 	int i;
-	uint32_t num;
-	mp_digit digits[(sizeof(uint32_t) + sizeof(mp_digit) - 1) /
+	isl_sioimath_usmall num;
+	mp_digit digits[(sizeof(isl_sioimath_usmall) + sizeof(mp_digit) - 1) /
 	                sizeof(mp_digit)];
 	mp_size used;
 	const unsigned char *digitdata = (const unsigned char *) &digits;
@@ -1155,9 +1288,9 @@ inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
 	if (isl_sioimath_decode_small(arg, &small)) {
 		if (small < 0)
 			isl_hash_byte(hash, 0xFF);
-		num = labs(small);
+		num = small < 0 ? -small : small;
 
-		isl_siomath_uint32_to_digits(num, digits, &used);
+		ISL_SIOIMATH_TO_DIGITS(num, digits, used);
 		for (i = 0; i < used * sizeof(mp_digit); i += 1)
 			isl_hash_byte(hash, digitdata[i]);
 		return hash;
@@ -1175,10 +1308,10 @@ inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
  */
 inline size_t isl_sioimath_sizeinbase(isl_sioimath_src arg, int base)
 {
-	int32_t small;
+	isl_sioimath_small small;
 
 	if (isl_sioimath_decode_small(arg, &small))
-		return sizeof(int32_t) * CHAR_BIT - 1;
+		return sizeof(isl_sioimath_small) * CHAR_BIT - 1;
 
 	return impz_sizeinbase(isl_sioimath_get_big(arg), base);
 }
@@ -18,6 +18,7 @@
 #include <isl_mat_private.h>
 #include <isl_val_private.h>
 #include <isl_vec_private.h>
+#include <isl_constraint_private.h>
 
 #include <bset_to_bmap.c>
 #include <set_to_map.c>
@@ -369,3 +370,266 @@ __isl_give isl_val *isl_basic_set_max_lp_val(__isl_keep isl_basic_set *bset,
 {
 	return isl_basic_set_opt_lp_val(bset, 1, obj);
 }
+
+/* A solver for a sequence of related linear programming problems
+ * over the rational points of a basic set.
+ *
+ * "bset" is the basic set over which the problems are solved,
+ * without any of the constraints added through
+ * isl_lp_solver_add_constraint.
+ * "tab" is a tableau representation of "bset" and the added constraints.
+ * The tableau is not rolled back after an optimization such that
+ * each optimization starts from the final basis of the previous one.
+ * "snap" contains, for each of the "n_snap" added constraints,
+ * the snapshot of "tab" right before the constraint was added.
+ * "size" is the size of the "snap" array.
+ * "v" is a vector of length 1 + the total number of variables of "bset"
+ * that is used to pass objective functions and constraints to "tab".
+ */
+struct isl_lp_solver {
+	isl_basic_set *bset;
+	struct isl_tab *tab;
+
+	int n_snap;
+	int size;
+	struct isl_tab_undo **snap;
+
+	isl_vec *v;
+};
+
+/* Construct a solver for linear programming problems
+ * over the rational points of "bset".
+ */
+__isl_give isl_lp_solver *isl_lp_solver_from_basic_set(
+	__isl_take isl_basic_set *bset)
+{
+	isl_ctx *ctx;
+	isl_size total;
+	isl_lp_solver *solver;
+
+	bset = isl_basic_set_gauss(bset, NULL);
+	total = isl_basic_set_dim(bset, isl_dim_all);
+	if (total < 0)
+		goto error;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	solver = isl_calloc_type(ctx, isl_lp_solver);
+	if (!solver)
+		goto error;
+	solver->bset = bset;
+	solver->tab = isl_tab_from_basic_set(bset, 0);
+	solver->v = isl_vec_alloc(ctx, 1 + total);
+	if (!solver->tab || !solver->v)
+		return isl_lp_solver_free(solver);
+
+	return solver;
+error:
+	isl_basic_set_free(bset);
+	return NULL;
+}
+
+__isl_null isl_lp_solver *isl_lp_solver_free(__isl_take isl_lp_solver *solver)
+{
+	if (!solver)
+		return NULL;
+
+	isl_basic_set_free(solver->bset);
+	isl_tab_free(solver->tab);
+	isl_vec_free(solver->v);
+	free(solver->snap);
+	free(solver);
+
+	return NULL;
+}
+
+isl_ctx *isl_lp_solver_get_ctx(__isl_keep isl_lp_solver *solver)
+{
+	return solver ? isl_basic_set_get_ctx(solver->bset) : NULL;
+}
+
+/* Check that "ls" lives in the same space as the basic set of "solver"
+ * and that it does not involve any local variables.
+ */
+static isl_stat isl_lp_solver_check_local_space(
+	__isl_keep isl_lp_solver *solver, __isl_keep isl_local_space *ls)
+{
+	isl_size n_div;
+
+	if (!solver || !ls)
+		return isl_stat_error;
+	if (!isl_space_is_equal(solver->bset->dim, ls->dim))
+		isl_die(isl_lp_solver_get_ctx(solver), isl_error_invalid,
+			"spaces don't match", return isl_stat_error);
+	n_div = isl_local_space_dim(ls, isl_dim_div);
+	if (n_div < 0)
+		return isl_stat_error;
+	if (n_div != 0)
+		isl_die(isl_lp_solver_get_ctx(solver), isl_error_unsupported,
+			"local variables not supported", return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Copy the constant term and the coefficients in "el"
+ * of an expression without local variables to solver->v,
+ * setting the coefficients of the local variables of solver->bset to zero.
+ */
+static void isl_lp_solver_set_v(__isl_keep isl_lp_solver *solver,
+	isl_int *el, int len)
+{
+	isl_seq_cpy(solver->v->el, el, len);
+	isl_seq_clr(solver->v->el + len, solver->v->size - len);
+}
+
+/* Return the optimal (rational) value of "obj" over the basic set
+ * of "solver" intersected with the constraints that have been added.
+ * If "max" is set, then the maximal value is computed.
+ * Otherwise, the minimal value is computed.
+ *
+ * Return infinity or negative infinity if the optimal value is unbounded and
+ * NaN if the set is empty.
+ *
+ * The tableau is left in the optimal basis of "obj"
+ * (or the basis in which unboundedness was detected),
+ * so that the next optimization can start from there.
+ */
+static __isl_give isl_val *isl_lp_solver_opt_val(
+	__isl_keep isl_lp_solver *solver, int max, __isl_keep isl_aff *obj)
+{
+	isl_ctx *ctx;
+	isl_val *res;
+	enum isl_lp_result lp_res;
+
+	if (!solver || !obj)
+		return NULL;
+	if (isl_lp_solver_check_local_space(solver, obj->ls) < 0)
+		return NULL;
+	ctx = isl_lp_solver_get_ctx(solver);
+	if (isl_aff_is_nan(obj))
+		return isl_val_nan(ctx);
+
+	isl_lp_solver_set_v(solver, obj->v->el + 1, obj->v->size - 1);
+	if (max)
+		isl_seq_neg(solver->v->el, solver->v->el, solver->v->size);
+	if (isl_tab_extend_cons(solver->tab, 1) < 0)
+		return NULL;
+
+	res = isl_val_alloc(ctx);
+	if (!res)
+		return NULL;
+	lp_res = isl_tab_min(solver->tab, solver->v->el, obj->v->el[0],
+				&res->n, &res->d, 0);
+	if (lp_res == isl_lp_ok) {
+		if (max)
+			isl_int_neg(res->n, res->n);
+		return isl_val_normalize(res);
+	}
+	isl_val_free(res);
+	if (lp_res == isl_lp_error)
+		return NULL;
+	if (lp_res == isl_lp_empty)
+		return isl_val_nan(ctx);
+	if (max)
+		return isl_val_infty(ctx);
+	else
+		return isl_val_neginfty(ctx);
+}
+
+/* Return the minimal (rational) value of "obj" over the basic set
+ * of "solver" intersected with the constraints that have been added.
+ *
+ * Return negative infinity if the minimal value is unbounded and
+ * NaN if the set is empty.
+ */
+__isl_give isl_val *isl_lp_solver_min_val(__isl_keep isl_lp_solver *solver,
+	__isl_keep isl_aff *obj)
+{
+	return isl_lp_solver_opt_val(solver, 0, obj);
+}
+
+/* Return the maximal (rational) value of "obj" over the basic set
+ * of "solver" intersected with the constraints that have been added.
+ *
+ * Return infinity if the maximal value is unbounded and
+ * NaN if the set is empty.
+ */
+__isl_give isl_val *isl_lp_solver_max_val(__isl_keep isl_lp_solver *solver,
+	__isl_keep isl_aff *obj)
+{
+	return isl_lp_solver_opt_val(solver, 1, obj);
+}
+
+/* Add the constraint "c" to the problems solved by "solver".
+ *
+ * A snapshot of the tableau is taken first such that
+ * the constraint can be removed again by
+ * isl_lp_solver_drop_last_constraint.
+ * If the tableau is already known to be empty, then there is
+ * no need to add the constraint to the tableau.
+ */
+__isl_give isl_lp_solver *isl_lp_solver_add_constraint(
+	__isl_take isl_lp_solver *solver, __isl_take isl_constraint *c)
+{
+	isl_stat r;
+
+	if (!solver || !c)
+		goto error;
+	if (isl_lp_solver_check_local_space(solver, c->ls) < 0)
+		goto error;
+
+	if (solver->n_snap >= solver->size) {
+		int size = 3 * (solver->size + 1) / 2;
+		struct isl_tab_undo **snap;
+
+		snap = isl_realloc_array(isl_lp_solver_get_ctx(solver),
+					solver->snap, struct isl_tab_undo *, size);
+		if (!snap)
+			goto error;
+		solver->snap = snap;
+		solver->size = size;
+	}
+	if (isl_tab_extend_cons(solver->tab, 1) < 0)
+		goto error;
+	solver->snap[solver->n_snap++] = isl_tab_snap(solver->tab);
+
+	if (!solver->tab->empty) {
+		isl_lp_solver_set_v(solver, c->v->el, c->v->size);
+		if (c->eq)
+			r = isl_tab_add_eq(solver->tab, solver->v->el);
+		else
+			r = isl_tab_add_ineq(solver->tab, solver->v->el);
+		if (r < 0)
+			goto error;
+	}
+
+	isl_constraint_free(c);
+	return solver;
+error:
+	isl_constraint_free(c);
+	return isl_lp_solver_free(solver);
+}
+
+/* Remove the constraint that was added last to "solver"
+ * by rolling back the tableau to the snapshot taken before it was added.
+ * The basis reached by the optimizations performed in the mean time
+ * is kept as much as possible.
+ * If there are no more added constraints left, then there is
+ * no longer any need to keep track of undo information.
+ */
+__isl_give isl_lp_solver *isl_lp_solver_drop_last_constraint(
+	__isl_take isl_lp_solver *solver)
+{
+	if (!solver)
+		return NULL;
+	if (solver->n_snap == 0)
+		isl_die(isl_lp_solver_get_ctx(solver), isl_error_invalid,
+			"no constraints to drop",
+			return isl_lp_solver_free(solver));
+
+	solver->n_snap--;
+	if (isl_tab_rollback(solver->tab, solver->snap[solver->n_snap]) < 0)
+		return isl_lp_solver_free(solver);
+	if (solver->n_snap == 0)
+		isl_tab_clear_undo(solver->tab);
+
+	return solver;
+}
@@ -50,6 +50,7 @@
 #include <isl_val_private.h>
 #include <isl_printer_private.h>
 #include <isl_maybe_aff.h>
+#include <isl_basic_map_cache.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -4243,12 +4244,110 @@ isl_bool isl_basic_set_contains(__isl_keep isl_basic_set *bset,
 	return isl_basic_map_contains(bset_to_bmap(bset), vec);
 }
 
+/* Are all constraints of "bmap2" redundant with respect to "bmap1",
+ * given that "bmap1" is known to be free of implicit equalities
+ * and redundant constraints and that "bmap2" only consists of inequalities
+ * and lives in the same space as "bmap1", but without local variables?
+ *
+ * Since the constraints of "bmap1" are known to be non-redundant
+ * (with respect to each other), only the constraints of "bmap2"
+ * need to be checked.  This is achieved by freezing the constraints
+ * of "bmap1" in the tableau such that isl_tab_detect_redundant
+ * skips them.
+ * The constraints of "bmap2" are not simply treated as
+ * additional constraints that can be checked separately,
+ * since they may also render some of the constraints of "bmap1" redundant.
+ * The caller therefore only exploits a positive answer.
+ */
+static isl_bool basic_map_ineqs_are_redundant(__isl_keep isl_basic_map *bmap1,
+	__isl_keep isl_basic_map *bmap2)
+{
+	int i;
+	int n_con;
+	isl_size total1, total2;
+	isl_vec *v;
+	struct isl_tab *tab;
+	isl_bool redundant = isl_bool_true;
+
+	total1 = isl_basic_map_dim(bmap1, isl_dim_all);
+	total2 = isl_basic_map_dim(bmap2, isl_dim_all);
+	if (total1 < 0 || total2 < 0)
+		return isl_bool_error;
+
+	v = isl_vec_zero(bmap1->ctx, 1 + total1);
+	tab = isl_tab_from_basic_map(bmap1, 0);
+	if (isl_tab_extend_cons(tab, bmap2->n_ineq) < 0 || !v)
+		goto error;
+	n_con = tab->n_con;
+	for (i = 0; i < n_con; ++i)
+		if (isl_tab_freeze_constraint(tab, i) < 0)
+			goto error;
+	for (i = 0; i < bmap2->n_ineq && !tab->empty; ++i) {
+		isl_seq_cpy(v->el, bmap2->ineq[i], 1 + total2);
+		if (isl_tab_add_ineq(tab, v->el) < 0)
+			goto error;
+	}
+	if (tab->empty)
+		redundant = isl_bool_false;
+	else if (isl_tab_detect_redundant(tab) < 0)
+		goto error;
+	for (i = n_con; redundant && i < tab->n_con; ++i)
+		if (!isl_tab_is_redundant(tab, i))
+			redundant = isl_bool_false;
+
+	isl_tab_free(tab);
+	isl_vec_free(v);
+	return redundant;
+error:
+	isl_tab_free(tab);
+	isl_vec_free(v);
+	return isl_bool_error;
+}
+
+/* Can the intersection of "bmap1" and "bmap2" be computed
+ * by only checking whether the constraints of "bmap2" are redundant
+ * with respect to "bmap1"?
+ * That is, is "bmap1" known to be free of implicit equalities
+ * and redundant constraints and does "bmap2" live in the same space,
+ * with the same rationality, but only consist of inequalities
+ * without any local variables?
+ * This is only attempted if requested by the user
+ * through the intersect_drop_redundant option
+ * since it requires the construction of a tableau.
+ */
+static isl_bool basic_map_intersect_is_incremental(
+	__isl_keep isl_basic_map *bmap1, __isl_keep isl_basic_map *bmap2)
+{
+	if (!bmap1->ctx->opt->intersect_drop_redundant)
+		return isl_bool_false;
+	if (!ISL_F_ISSET(bmap1, ISL_BASIC_MAP_NO_REDUNDANT) ||
+	    !ISL_F_ISSET(bmap1, ISL_BASIC_MAP_NO_IMPLICIT))
+		return isl_bool_false;
+	if (bmap2->n_eq != 0 || bmap2->n_div != 0 || bmap2->n_ineq == 0)
+		return isl_bool_false;
+	if (ISL_F_ISSET(bmap1, ISL_BASIC_MAP_RATIONAL) !=
+	    ISL_F_ISSET(bmap2, ISL_BASIC_MAP_RATIONAL))
+		return isl_bool_false;
+	return isl_space_is_equal(bmap1->dim, bmap2->dim);
+}
+
+/* Intersect "bmap1" and "bmap2".
+ *
+ * If the intersect_drop_redundant option is set,
+ * "bmap1" is known to be free of redundant constraints and
+ * all constraints of "bmap2" turn out to be redundant with respect
+ * to "bmap1", then the result is simply "bmap1", which remains
+ * free of redundant constraints.
+ * This avoids the need to check all constraints again
+ * in a subsequent call to isl_basic_map_remove_redundancies.
+ */
 __isl_give isl_basic_map *isl_basic_map_intersect(
 	__isl_take isl_basic_map *bmap1, __isl_take isl_basic_map *bmap2)
 {
 	struct isl_vec *sample = NULL;
 	isl_space *space1, *space2;
 	isl_size dim1, dim2, nparam1, nparam2;
+	isl_bool incremental;
 
 	if (isl_basic_map_check_equal_params(bmap1, bmap2) < 0)
 		goto error;
@@ -4276,6 +4375,16 @@ __isl_give isl_basic_map *isl_basic_map_intersect(
 		return bmap2;
 	}
 
+	incremental = basic_map_intersect_is_incremental(bmap1, bmap2);
+	if (incremental == isl_bool_true)
+		incremental = basic_map_ineqs_are_redundant(bmap1, bmap2);
+	if (incremental < 0)
+		goto error;
+	if (incremental) {
+		isl_basic_map_free(bmap2);
+		return bmap1;
+	}
+
 	if (bmap1->sample &&
 	    isl_basic_map_contains(bmap1, bmap1->sample) > 0 &&
 	    isl_basic_map_contains(bmap2, bmap1->sample) > 0)
@@ -6520,6 +6629,62 @@ error:
 	return NULL;
 }
 
+/* Replace the space of "bmap" by "space" if they are identical,
+ * including the identifiers of all dimensions.
+ * Since the meaning of "bmap" is not affected,
+ * the space is replaced in-place.
+ */
+static isl_stat basic_map_replace_identical_space(
+	__isl_keep isl_basic_map *bmap, __isl_keep isl_space *space)
+{
+	isl_bool equal;
+
+	if (bmap->dim == space)
+		return isl_stat_ok;
+	equal = isl_space_is_equal(bmap->dim, space);
+	if (equal >= 0 && equal)
+		equal = isl_space_has_equal_ids(bmap->dim, space);
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		return isl_stat_ok;
+	isl_space_free(bmap->dim);
+	bmap->dim = isl_space_copy(space);
+	return isl_stat_ok;
+}
+
+/* Replace the space of "map" and those of its basic maps
+ * by the canonical copy of the space of "map" (see isl_space_intern).
+ *
+ * Since the canonical copy is identical to the original space,
+ * the meaning of "map" is not affected and the spaces can be replaced
+ * in-place, even if "map" or its basic maps have multiple references.
+ */
+__isl_give isl_map *isl_map_intern_space(__isl_take isl_map *map)
+{
+	int i;
+	isl_space *space;
+
+	space = isl_space_intern(isl_map_get_space(map));
+	if (!space)
+		return isl_map_free(map);
+
+	for (i = 0; i < map->n; ++i)
+		if (basic_map_replace_identical_space(map->p[i], space) < 0)
+			goto error;
+	if (map->dim != space) {
+		isl_space_free(map->dim);
+		map->dim = isl_space_copy(space);
+	}
+
+	isl_space_free(space);
+	return map;
+error:
+	isl_space_free(space);
+	isl_map_free(map);
+	return NULL;
+}
+
 __isl_give isl_set *isl_set_reset_space(__isl_take isl_set *set,
 	__isl_take isl_space *space)
 {
@@ -10041,10 +10206,39 @@ isl_bool isl_set_plain_is_universe(__isl_keep isl_set *set)
 	return isl_map_plain_is_universe(set_to_map(set));
 }
 
-isl_bool isl_basic_map_is_empty(__isl_keep isl_basic_map *bmap)
+/* Is "bmap" empty, given that it is not known to be empty or non-empty
+ * based on its representation?
+ * Look for an integer point in "bmap" and store it in bmap->sample.
+ */
+static isl_bool basic_map_sample_is_empty(__isl_keep isl_basic_map *bmap)
 {
 	struct isl_basic_set *bset = NULL;
 	struct isl_vec *sample = NULL;
+	isl_bool empty;
+
+	isl_vec_free(bmap->sample);
+	bmap->sample = NULL;
+	bset = isl_basic_map_underlying_set(isl_basic_map_copy(bmap));
+	if (!bset)
+		return isl_bool_error;
+	sample = isl_basic_set_sample_vec(bset);
+	if (!sample)
+		return isl_bool_error;
+	empty = sample->size == 0;
+	isl_vec_free(bmap->sample);
+	bmap->sample = sample;
+
+	return empty;
+}
+
+/* Is "bmap" empty?
+ *
+ * If the cheap tests are inconclusive, then look for an integer point
+ * in "bmap", reusing the outcome of an earlier test
+ * on an identical basic map if the basic map cache is enabled.
+ */
+isl_bool isl_basic_map_is_empty(__isl_keep isl_basic_map *bmap)
+{
 	isl_bool empty, non_empty;
 
 	if (!bmap)
@@ -10069,18 +10263,9 @@ isl_bool isl_basic_map_is_empty(__isl_keep isl_basic_map *bmap)
 		return isl_bool_error;
 	if (non_empty)
 		return isl_bool_false;
-	isl_vec_free(bmap->sample);
-	bmap->sample = NULL;
-	bset = isl_basic_map_underlying_set(isl_basic_map_copy(bmap));
-	if (!bset)
-		return isl_bool_error;
-	sample = isl_basic_set_sample_vec(bset);
-	if (!sample)
-		return isl_bool_error;
-	empty = sample->size == 0;
-	isl_vec_free(bmap->sample);
-	bmap->sample = sample;
-	if (empty)
+	empty = isl_basic_map_cache_test(bmap, isl_basic_map_cache_is_empty,
+					&basic_map_sample_is_empty);
+	if (empty == isl_bool_true)
 		ISL_F_SET(bmap, ISL_BASIC_MAP_EMPTY);
 
 	return empty;
@@ -10125,6 +10310,112 @@ isl_bool isl_basic_set_is_empty(__isl_keep isl_basic_set *bset)
 	return isl_basic_map_is_empty(bset_to_bmap(bset));
 }
 
+/* The maximal number of sample points that are kept
+ * by isl_basic_set_list_each_is_empty.
+ */
+#define ISL_LIST_EMPTY_SAMPLES	8
+
+/* Try and show that "bset" is non-empty by checking whether
+ * any of the "n" sample points in "sample" belongs to "bset".
+ * If so, store the sample point in "bset" for later use.
+ * This can only be done if "bset" has no local variables
+ * since the sample points do not contain values for
+ * the local variables of "bset".
+ * The sample points may have been taken from rational elements,
+ * so only those with a unit denominator are considered
+ * if "bset" is not rational.
+ */
+static isl_bool basic_set_contains_any(__isl_keep isl_basic_set *bset,
+	int n, isl_vec **sample)
+{
+	int i;
+	int rational;
+
+	if (bset->n_div != 0)
+		return isl_bool_false;
+
+	rational = ISL_F_ISSET(bset, ISL_BASIC_SET_RATIONAL);
+	for (i = 0; i < n; ++i) {
+		isl_bool contains;
+
+		if (!rational && !isl_int_is_one(sample[i]->el[0]))
+			continue;
+		contains = isl_basic_set_contains(bset, sample[i]);
+		if (contains < 0)
+			return isl_bool_error;
+		if (!contains)
+			continue;
+		isl_vec_free(bset->sample);
+		bset->sample = isl_vec_copy(sample[i]);
+		return contains;
+	}
+
+	return isl_bool_false;
+}
+
+/* Determine for each element of "list" whether it is empty and
+ * store the result in the corresponding element of "empty",
+ * which is assumed to have room for as many elements as "list".
+ *
+ * The elements are typically small basic sets in the same space
+ * and a point in one of them often also belongs to some of the others.
+ * The last ISL_LIST_EMPTY_SAMPLES sample points that were found
+ * in elements without local variables are therefore kept and
+ * checked against each subsequent element without local variables
+ * before falling back to isl_basic_set_is_empty.
+ * Such a check only involves evaluating the constraints of the element,
+ * which is much cheaper than setting up a tableau to look for a sample.
+ */
+isl_stat isl_basic_set_list_each_is_empty(
+	__isl_keep isl_basic_set_list *list, isl_bool *empty)
+{
+	int i, j;
+	int n_found = 0;
+	isl_size n;
+	isl_vec *sample[ISL_LIST_EMPTY_SAMPLES];
+
+	n = isl_basic_set_list_n_basic_set(list);
+	if (n < 0 || (n > 0 && !empty))
+		return isl_stat_error;
+
+	for (i = 0; i < n; ++i) {
+		isl_basic_set *bset;
+		isl_bool non_empty;
+		int n_sample;
+
+		bset = isl_basic_set_list_get_basic_set(list, i);
+		if (!bset)
+			break;
+		n_sample = n_found < ISL_LIST_EMPTY_SAMPLES ?
+					n_found : ISL_LIST_EMPTY_SAMPLES;
+		non_empty = isl_bool_false;
+		if (!isl_basic_set_plain_is_empty(bset))
+			non_empty = basic_set_contains_any(bset,
+							n_sample, sample);
+		if (non_empty)
+			empty[i] = isl_bool_not(non_empty);
+		else
+			empty[i] = isl_basic_set_is_empty(bset);
+		if (!non_empty && empty[i] == isl_bool_false &&
+		    bset->n_div == 0 && bset->sample) {
+			j = n_found++ % ISL_LIST_EMPTY_SAMPLES;
+			if (j < n_sample)
+				isl_vec_free(sample[j]);
+			sample[j] = isl_vec_copy(bset->sample);
+		}
+		isl_basic_set_free(bset);
+		if (empty[i] < 0)
+			break;
+	}
+
+	if (n_found > ISL_LIST_EMPTY_SAMPLES)
+		n_found = ISL_LIST_EMPTY_SAMPLES;
+	for (j = 0; j < n_found; ++j)
+		isl_vec_free(sample[j]);
+
+	return i < n ? isl_stat_error : isl_stat_ok;
+}
+
 __isl_give isl_map *isl_basic_map_union(__isl_take isl_basic_map *bmap1,
 	__isl_take isl_basic_map *bmap2)
 {
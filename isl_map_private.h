@@ -126,6 +126,7 @@ __isl_give isl_basic_set *isl_basic_set_extend_constraints(
 __isl_give isl_basic_set *isl_basic_set_finalize(
 	__isl_take isl_basic_set *bset);
 __isl_give isl_basic_set *isl_basic_set_dup(__isl_keep isl_basic_set *bset);
+__isl_give isl_basic_map *isl_basic_map_dup(__isl_keep isl_basic_map *bmap);
 __isl_give isl_basic_set *isl_basic_set_simplify(
 	__isl_take isl_basic_set *bset);
 
@@ -173,6 +174,7 @@ __isl_give isl_basic_map *isl_basic_map_reset_space(
 	__isl_take isl_basic_map *bmap, __isl_take isl_space *space);
 __isl_give isl_map *isl_map_reset_space(__isl_take isl_map *map,
 	__isl_take isl_space *space);
+__isl_give isl_map *isl_map_intern_space(__isl_take isl_map *map);
 __isl_give isl_map *isl_map_reset_equal_dim_space(__isl_take isl_map *map,
 	__isl_take isl_space *space);
 
@@ -344,6 +346,8 @@ __isl_give isl_map *isl_map_drop(__isl_take isl_map *map,
 	enum isl_dim_type type, unsigned first, unsigned n);
 __isl_give isl_basic_map *isl_basic_map_drop_unrelated_constraints(
 	__isl_take isl_basic_map *bmap, __isl_take int *group);
+__isl_give isl_basic_map *isl_basic_map_drop_redundant_by_bounds(
+	__isl_take isl_basic_map *bmap);
 
 __isl_give isl_basic_map *isl_basic_map_remove_unknown_divs(
 	__isl_take isl_basic_map *bmap);
@@ -359,6 +363,7 @@ __isl_give isl_map *isl_map_remove_empty_parts(__isl_take isl_map *map);
 __isl_give isl_set *isl_set_remove_empty_parts(__isl_take isl_set *set);
 __isl_give isl_map *isl_map_remove_obvious_duplicates(__isl_take isl_map *map);
 
+__isl_give isl_map *isl_map_normalize(__isl_take isl_map *map);
 __isl_give isl_set *isl_set_normalize(__isl_take isl_set *set);
 
 __isl_give isl_basic_map *isl_basic_map_eliminate_vars(
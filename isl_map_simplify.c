@@ -24,6 +24,7 @@
 #include <isl_space_private.h>
 #include <isl_mat_private.h>
 #include <isl_vec_private.h>
+#include <isl_basic_map_cache.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -2422,7 +2423,8 @@ __isl_give isl_basic_map *isl_basic_map_eliminate_pure_unit_divs(
 	return eliminate_selected_unit_divs(bmap, &is_pure_unit_div, NULL);
 }
 
-__isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
+static __isl_give isl_basic_map *basic_map_simplify(
+	__isl_take isl_basic_map *bmap)
 {
 	int progress = 1;
 	if (!bmap)
@@ -2453,6 +2455,23 @@ __isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
 	return bmap;
 }
 
+/* Simplify the representation of "bmap",
+ * reusing the result of an earlier simplification
+ * of an identical basic map if the basic map cache is enabled.
+ */
+__isl_give isl_basic_map *isl_basic_map_simplify(__isl_take isl_basic_map *bmap)
+{
+	isl_bool empty;
+
+	empty = isl_basic_map_plain_is_empty(bmap);
+	if (empty < 0)
+		return isl_basic_map_free(bmap);
+	if (empty)
+		return bmap;
+	return isl_basic_map_cache_apply(bmap, isl_basic_map_cache_simplify,
+					&basic_map_simplify);
+}
+
 __isl_give isl_basic_set *isl_basic_set_simplify(
 	__isl_take isl_basic_set *bset)
 {
@@ -3239,6 +3258,248 @@ error:
 	return NULL;
 }
 
+/* If "c" is an inequality constraint on the single variable
+ * at position "pos", then return "pos".
+ * Otherwise, return -1.
+ */
+static int single_var_pos(isl_int *c, int total)
+{
+	int pos;
+
+	pos = isl_seq_first_non_zero(c + 1, total);
+	if (pos < 0)
+		return -1;
+	if (isl_seq_any_non_zero(c + 1 + pos + 1, total - pos - 1))
+		return -1;
+	return pos;
+}
+
+/* Compute the sign of the difference between the bound
+ * imposed by the inequality constraints "c1" and "c2"
+ * on the variable at position "pos", where "c1" and "c2"
+ * only involve this variable (with coefficients of the same sign).
+ * That is, with c1 = a1 x + b1 >= 0 and c2 = a2 x + b2 >= 0,
+ * compute the sign of -b1/a1 - (-b2/a2), i.e., of b2 a1 - b1 a2
+ * if a1 and a2 are positive and of b1 a2 - b2 a1 if they are negative.
+ * Return the sign of b2 a1 - b1 a2 in both cases such that
+ * a positive result means that "c1" is a tighter lower bound
+ * (in case a1 and a2 are positive) or a weaker upper bound
+ * (in case a1 and a2 are negative) than "c2".
+ * "t" is a temporary variable.
+ */
+static int bound_cmp(isl_int *c1, isl_int *c2, int pos, isl_int *t)
+{
+	isl_int_mul(*t, c2[0], c1[1 + pos]);
+	isl_int_submul(*t, c1[0], c2[1 + pos]);
+	return isl_int_sgn(*t);
+}
+
+/* Compute the minimal (or maximal if "max" is set) value n/d of
+ * the inequality constraint "c" over the box defined by
+ * the bound constraints of "bmap" collected in "lower" and "upper",
+ * with "d" positive.
+ * Return 0 if this value is unbounded and 1 otherwise.
+ *
+ * The value of the variable at position k at the optimum is -b/a
+ * for the bound constraint a x_k + b >= 0,
+ * so it contributes -c_k b/a to the value of "c".
+ */
+static int box_opt(__isl_keep isl_basic_map *bmap, int total,
+	int *lower, int *upper, isl_int *c, int max, isl_int *n, isl_int *d,
+	isl_int *t)
+{
+	int k;
+
+	isl_int_set(*n, c[0]);
+	isl_int_set_si(*d, 1);
+	for (k = 0; k < total; ++k) {
+		int sgn = isl_int_sgn(c[1 + k]);
+		int b;
+		isl_int *bound;
+
+		if (sgn == 0)
+			continue;
+		b = (sgn > 0) != max ? lower[k] : upper[k];
+		if (b < 0)
+			return 0;
+		bound = bmap->ineq[b];
+		isl_int_mul(*n, *n, bound[1 + k]);
+		isl_int_mul(*t, c[1 + k], bound[0]);
+		isl_int_mul(*t, *t, *d);
+		isl_int_sub(*n, *n, *t);
+		isl_int_mul(*d, *d, bound[1 + k]);
+		if (isl_int_is_neg(*d)) {
+			isl_int_neg(*n, *n);
+			isl_int_neg(*d, *d);
+		}
+	}
+
+	return 1;
+}
+
+/* Is the inequality constraint "c" of "bmap" a constraint
+ * that defines one of the integer divisions?
+ * Such constraints are kept in isl_basic_map_drop_redundant_by_bounds
+ * even if they are redundant.
+ */
+static isl_bool is_any_div_constraint(__isl_keep isl_basic_map *bmap,
+	isl_int *c)
+{
+	int i;
+
+	for (i = 0; i < bmap->n_div; ++i) {
+		isl_bool is_div;
+
+		is_div = isl_basic_map_is_div_constraint(bmap, c, i);
+		if (is_div < 0 || is_div)
+			return is_div;
+	}
+	return isl_bool_false;
+}
+
+/* Drop inequality constraints from "bmap" that are obviously redundant
+ * with respect to the bounds on individual variables and
+ * detect some obviously empty basic maps, without any need
+ * for setting up a tableau.
+ *
+ * First collect, for each variable, the tightest lower and upper bound
+ * imposed by an inequality constraint that only involves that variable.
+ * If the lower bound is greater than the upper bound for some variable,
+ * then "bmap" is empty.
+ * Bound constraints that are not the tightest are redundant.
+ * Any other inequality constraint is redundant if its minimal value
+ * over the box defined by the tightest bounds is non-negative.
+ * For integral basic maps, it would be sufficient for this minimal value
+ * to be greater than -1, but then the constraints that remain
+ * may depend on the order in which the constraints are considered,
+ * so this is left to the tableau based check, which removes
+ * constraints in a well-defined order.
+ * If, on the other hand, its maximal value over this box is negative,
+ * then "bmap" is empty.
+ * Constraints that define an integer division are always kept.
+ * The redundant constraints are only dropped after all constraints
+ * have been considered since dropping a constraint changes
+ * the positions of the other constraints.
+ *
+ * The equality constraints are not taken into account,
+ * so this may miss some redundancies, but they will then
+ * be detected by a subsequent tableau based check.
+ */
+__isl_give isl_basic_map *isl_basic_map_drop_redundant_by_bounds(
+	__isl_take isl_basic_map *bmap)
+{
+	int i;
+	int empty = 0;
+	isl_size total;
+	int *lower = NULL, *upper = NULL, *pos = NULL;
+	isl_int n, d, t;
+
+	total = isl_basic_map_dim(bmap, isl_dim_all);
+	if (total < 0)
+		return isl_basic_map_free(bmap);
+	if (bmap->n_ineq <= 1)
+		return bmap;
+
+	lower = isl_alloc_array(bmap->ctx, int, total);
+	upper = isl_alloc_array(bmap->ctx, int, total);
+	pos = isl_alloc_array(bmap->ctx, int, bmap->n_ineq);
+	if ((total && (!lower || !upper)) || !pos)
+		goto error;
+
+	isl_int_init(n);
+	isl_int_init(d);
+	isl_int_init(t);
+
+	for (i = 0; i < total; ++i)
+		lower[i] = upper[i] = -1;
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		int *best;
+		int k = single_var_pos(bmap->ineq[i], total);
+
+		pos[i] = k;
+		if (k < 0)
+			continue;
+		if (isl_int_is_pos(bmap->ineq[i][1 + k])) {
+			best = &lower[k];
+			if (*best < 0 || bound_cmp(bmap->ineq[i],
+					bmap->ineq[*best], k, &t) > 0)
+				*best = i;
+		} else {
+			best = &upper[k];
+			if (*best < 0 || bound_cmp(bmap->ineq[i],
+					bmap->ineq[*best], k, &t) < 0)
+				*best = i;
+		}
+	}
+
+	for (i = 0; i < total; ++i) {
+		isl_int *l, *u;
+
+		if (lower[i] < 0 || upper[i] < 0)
+			continue;
+		l = bmap->ineq[lower[i]];
+		u = bmap->ineq[upper[i]];
+		isl_int_mul(t, u[0], l[1 + i]);
+		isl_int_submul(t, l[0], u[1 + i]);
+		if (isl_int_is_neg(t))
+			break;
+	}
+	empty = i < total;
+
+	for (i = bmap->n_ineq - 1; !empty && i >= 0; --i) {
+		int redundant;
+		isl_bool is_div;
+
+		if (pos[i] >= 0) {
+			redundant = lower[pos[i]] != i && upper[pos[i]] != i;
+		} else {
+			if (box_opt(bmap, total, lower, upper, bmap->ineq[i],
+				    1, &n, &d, &t) && isl_int_is_neg(n)) {
+				empty = 1;
+				break;
+			}
+			redundant = box_opt(bmap, total, lower, upper,
+					    bmap->ineq[i], 0, &n, &d, &t) &&
+				    !isl_int_is_neg(n);
+		}
+		if (!redundant)
+			continue;
+		is_div = is_any_div_constraint(bmap, bmap->ineq[i]);
+		if (is_div < 0)
+			goto error_int;
+		if (!is_div)
+			pos[i] = -2;
+	}
+
+	for (i = bmap->n_ineq - 1; !empty && i >= 0; --i) {
+		if (pos[i] != -2)
+			continue;
+		bmap = isl_basic_map_cow(bmap);
+		if (isl_basic_map_drop_inequality(bmap, i) < 0)
+			goto error_int;
+	}
+
+	isl_int_clear(n);
+	isl_int_clear(d);
+	isl_int_clear(t);
+	free(lower);
+	free(upper);
+	free(pos);
+
+	if (empty)
+		bmap = isl_basic_map_set_to_empty(bmap);
+	return bmap;
+error_int:
+	isl_int_clear(n);
+	isl_int_clear(d);
+	isl_int_clear(t);
+error:
+	free(lower);
+	free(upper);
+	free(pos);
+	return isl_basic_map_free(bmap);
+}
+
 /* Drop constraints from "context" that are irrelevant for computing
  * the gist of "bset".
  *
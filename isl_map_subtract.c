@@ -7,6 +7,7 @@
  * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
  */
 
+#include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_seq.h>
 #include <isl/set.h>
@@ -472,6 +473,166 @@ error:
 	return isl_stat_error;
 }
 
+/* Is the constraint "c" of a basic map with "n_div" divs
+ * and "total" other variables independent of the divs?
+ */
+static int is_div_free(isl_int *c, unsigned total, unsigned n_div)
+{
+	return isl_seq_first_non_zero(c + 1 + total, n_div) == -1;
+}
+
+/* Can the div-free constraints "c1" and "c2" not be satisfied
+ * simultaneously, not even by a rational point?
+ * If "eq1" or "eq2" is set, then the corresponding constraint
+ * is an equality, i.e., it also holds in negated form.
+ *
+ * If the linear part of "c1" is the negation of that of "c2",
+ * then the constraints are incompatible if the sum of the constant terms
+ * is negative, or, if both are equalities, non-zero.
+ * If the linear parts are equal and (at least) one of them
+ * is an equality, then the equality can be negated and
+ * the same reasoning applies to the difference of the constant terms.
+ */
+static int is_separating_pair(isl_int *c1, int eq1, isl_int *c2, int eq2,
+	unsigned total, isl_int *tmp)
+{
+	if (isl_seq_is_neg(c1 + 1, c2 + 1, total)) {
+		isl_int_add(*tmp, c1[0], c2[0]);
+	} else if ((eq1 || eq2) && isl_seq_eq(c1 + 1, c2 + 1, total)) {
+		if (eq1)
+			isl_int_sub(*tmp, c2[0], c1[0]);
+		else
+			isl_int_sub(*tmp, c1[0], c2[0]);
+	} else {
+		return 0;
+	}
+
+	if (isl_int_is_neg(*tmp))
+		return 1;
+	return eq1 && eq2 && !isl_int_is_zero(*tmp);
+}
+
+/* Is the constraint "c" of "bmap1" (an equality if "eq" is set)
+ * in direct contradiction with one of the div-free constraints of "bmap2"?
+ */
+static int constraint_is_separating(isl_int *c, int eq,
+	__isl_keep isl_basic_map *bmap2, unsigned total, isl_int *tmp)
+{
+	int i;
+
+	for (i = 0; i < bmap2->n_eq; ++i) {
+		if (!is_div_free(bmap2->eq[i], total, bmap2->n_div))
+			continue;
+		if (is_separating_pair(c, eq, bmap2->eq[i], 1, total, tmp))
+			return 1;
+	}
+	for (i = 0; i < bmap2->n_ineq; ++i) {
+		if (!is_div_free(bmap2->ineq[i], total, bmap2->n_div))
+			continue;
+		if (is_separating_pair(c, eq, bmap2->ineq[i], 0, total, tmp))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Are "bmap1" and "bmap2" obviously disjoint, based on a pair
+ * of constraints that do not involve any divs and that cannot
+ * be satisfied simultaneously, not even by a rational point?
+ * For example, i <= n - 1 and i >= n.
+ *
+ * The two basic maps are assumed to live in the same space.
+ * Since only constraints that do not involve any divs are considered,
+ * the local variables of the two basic maps do not need to be matched.
+ * Comparing constraints directly, without constructing any tableau,
+ * is cheap, while pairs of basic maps that are separated
+ * by such a pair of constraints are very common in practice,
+ * e.g., in dependence analysis.
+ */
+static isl_bool basic_map_plain_is_separated(__isl_keep isl_basic_map *bmap1,
+	__isl_keep isl_basic_map *bmap2)
+{
+	int i;
+	int separated = 0;
+	isl_size total;
+	isl_int tmp;
+
+	total = isl_basic_map_dim(bmap1, isl_dim_all);
+	if (total < 0 || !bmap2)
+		return isl_bool_error;
+	total -= bmap1->n_div;
+
+	isl_int_init(tmp);
+	for (i = 0; !separated && i < bmap1->n_eq; ++i) {
+		if (!is_div_free(bmap1->eq[i], total, bmap1->n_div))
+			continue;
+		separated = constraint_is_separating(bmap1->eq[i], 1,
+							bmap2, total, &tmp);
+	}
+	for (i = 0; !separated && i < bmap1->n_ineq; ++i) {
+		if (!is_div_free(bmap1->ineq[i], total, bmap1->n_div))
+			continue;
+		separated = constraint_is_separating(bmap1->ineq[i], 0,
+							bmap2, total, &tmp);
+	}
+	isl_int_clear(tmp);
+
+	return isl_bool_ok(separated);
+}
+
+/* Return a copy of "map" without the basic maps that are obviously
+ * disjoint from "bmap", as determined by basic_map_plain_is_separated.
+ * Removing these basic maps does not affect the set difference
+ * between "bmap" and "map", but it avoids the construction
+ * of tableaux that would only confirm that they do not intersect "bmap".
+ * The number of considered and pruned pairs is kept track of
+ * in the statistics of the context.
+ */
+static __isl_give isl_map *drop_separated(__isl_keep isl_basic_map *bmap,
+	__isl_keep isl_map *map)
+{
+	int i, j;
+	isl_ctx *ctx;
+	isl_map *res;
+
+	if (!bmap || !map)
+		return NULL;
+
+	ctx = isl_map_get_ctx(map);
+	for (i = 0; i < map->n; ++i) {
+		isl_bool separated;
+
+		ctx->stats->subtract_pairs++;
+		separated = basic_map_plain_is_separated(bmap, map->p[i]);
+		if (separated < 0)
+			return NULL;
+		if (separated)
+			break;
+	}
+	if (i >= map->n)
+		return isl_map_copy(map);
+
+	ctx->stats->subtract_pruned_pairs++;
+	res = isl_map_alloc_space(isl_map_get_space(map), map->n, map->flags);
+	for (j = 0; j < i; ++j)
+		res = isl_map_add_basic_map(res, isl_basic_map_copy(map->p[j]));
+	for (j = i + 1; j < map->n; ++j) {
+		isl_bool separated;
+
+		ctx->stats->subtract_pairs++;
+		separated = basic_map_plain_is_separated(bmap, map->p[j]);
+		if (separated < 0)
+			return isl_map_free(res);
+		if (separated) {
+			ctx->stats->subtract_pruned_pairs++;
+			continue;
+		}
+		res = isl_map_add_basic_map(res, isl_basic_map_copy(map->p[j]));
+	}
+
+	return res;
+}
+
 /* A diff collector that actually collects all parts of the
  * set difference in the field diff.
  */
@@ -495,11 +656,19 @@ static isl_stat basic_map_subtract_add(struct isl_diff_collector *dc,
 }
 
 /* Return the set difference between bmap and map.
+ *
+ * The basic maps of "map" that are obviously disjoint from "bmap"
+ * are removed first.
  */
 static __isl_give isl_map *basic_map_subtract(__isl_take isl_basic_map *bmap,
 	__isl_take isl_map *map)
 {
+	isl_map *pruned;
 	struct isl_subtract_diff_collector sdc;
+
+	pruned = drop_separated(bmap, map);
+	isl_map_free(map);
+	map = pruned;
 	sdc.dc.add = &basic_map_subtract_add;
 	sdc.diff = isl_map_empty(isl_basic_map_get_space(bmap));
 	if (basic_map_collect_diff(bmap, map, &sdc.dc) < 0) {
@@ -530,7 +699,7 @@ static __isl_give isl_map *replace_pair_by_empty( __isl_take isl_map *map1,
  *
  * If "map1" and "map2" are disjoint, then simply return "map1".
  */
-__isl_give isl_map *isl_map_subtract( __isl_take isl_map *map1,
+static __isl_give isl_map *map_subtract( __isl_take isl_map *map1,
 	__isl_take isl_map *map2)
 {
 	int i;
@@ -585,6 +754,30 @@ error:
 	return NULL;
 }
 
+/* Return the set difference between map1 and map2.
+ *
+ * The computation involves many temporary tableaux,
+ * so perform it inside a block retention scope.
+ */
+__isl_give isl_map *isl_map_subtract( __isl_take isl_map *map1,
+	__isl_take isl_map *map2)
+{
+	isl_ctx *ctx;
+	isl_map *diff;
+
+	ctx = isl_map_get_ctx(map1);
+	if (isl_ctx_push_block_retention(ctx) < 0)
+		goto error;
+	diff = map_subtract(map1, map2);
+	if (isl_ctx_pop_block_retention(ctx) < 0)
+		return isl_map_free(diff);
+	return diff;
+error:
+	isl_map_free(map1);
+	isl_map_free(map2);
+	return NULL;
+}
+
 __isl_give isl_set *isl_set_subtract(__isl_take isl_set *set1,
 	__isl_take isl_set *set2)
 {
@@ -666,6 +859,8 @@ static isl_stat basic_map_is_empty_add(struct isl_diff_collector *dc,
 
 /* Check if bmap \ map is empty by computing this set difference
  * and breaking off as soon as the difference is known to be non-empty.
+ * The basic maps of "map" that are obviously disjoint from "bmap"
+ * are not taken into account.
  */
 static isl_bool basic_map_diff_is_empty(__isl_keep isl_basic_map *bmap,
 	__isl_keep isl_map *map)
@@ -681,7 +876,7 @@ static isl_bool basic_map_diff_is_empty(__isl_keep isl_basic_map *bmap,
 	edc.dc.add = &basic_map_is_empty_add;
 	edc.empty = isl_bool_true;
 	r = basic_map_collect_diff(isl_basic_map_copy(bmap),
-				   isl_map_copy(map), &edc.dc);
+				   drop_separated(bmap, map), &edc.dc);
 	if (!edc.empty)
 		return isl_bool_false;
 
@@ -874,10 +1069,24 @@ static isl_bool map_is_subset(__isl_keep isl_map *map1,
 	return is_subset;
 }
 
+/* Is "map1" a subset of "map2"?
+ *
+ * The computation involves many temporary tableaux,
+ * so perform it inside a block retention scope.
+ */
 isl_bool isl_map_is_subset(__isl_keep isl_map *map1, __isl_keep isl_map *map2)
 {
-	return isl_map_align_params_map_map_and_test(map1, map2,
+	isl_ctx *ctx;
+	isl_bool is_subset;
+
+	ctx = isl_map_get_ctx(map1);
+	if (isl_ctx_push_block_retention(ctx) < 0)
+		return isl_bool_error;
+	is_subset = isl_map_align_params_map_map_and_test(map1, map2,
 							&map_is_subset);
+	if (isl_ctx_pop_block_retention(ctx) < 0)
+		return isl_bool_error;
+	return is_subset;
 }
 
 isl_bool isl_set_is_subset(__isl_keep isl_set *set1, __isl_keep isl_set *set2)
@@ -177,6 +177,16 @@ ISL_ARG_BOOL(struct isl_options, schedule_carry_self_first, 0,
 ISL_ARG_BOOL(struct isl_options, schedule_serialize_sccs, 0,
 	"schedule-serialize-sccs", 0,
 	"serialize strongly connected components in dependence graph")
+ISL_ARG_INT(struct isl_options, schedule_cache_slots, 0,
+	"schedule-cache-slots", "n", 256, "Number of schedules that "
+	"can be kept in an on-disk schedule cache directory.")
+ISL_ARG_INT(struct isl_options, schedule_cache_max_entry_size, 0,
+	"schedule-cache-max-entry-size", "bytes", 1 << 20, "Maximal size "
+	"of a single entry in an on-disk schedule cache directory.")
+ISL_ARG_INT(struct isl_options, schedule_max_operations, 0,
+	"schedule-max-operations", "n", 0, "Maximal number of operations "
+	"spent on scheduling a single component before falling back "
+	"to simpler schedules (0 = no limit).")
 ISL_ARG_PHANTOM_USER_CHOICE_F(0, "schedule-fuse", fuse, &set_fuse,
 	ISL_SCHEDULE_FUSE_MAX, "level of fusion during scheduling",
 	ISL_ARG_HIDDEN)
@@ -217,8 +227,22 @@ ISL_ARG_BOOL(struct isl_options, ast_build_allow_else, 0,
 	"ast-build-allow-else", 1, "generate if statements with else branches")
 ISL_ARG_BOOL(struct isl_options, ast_build_allow_or, 0,
 	"ast-build-allow-or", 1, "generate if conditions with disjunctions")
+ISL_ARG_BOOL(struct isl_options, intern_spaces, 0, "intern-spaces", 0,
+	"share identical spaces of union maps and union sets")
+ISL_ARG_INT(struct isl_options, basic_map_cache_size, 0,
+	"basic-map-cache-size", "bytes", 0, "cache the results of "
+	"emptiness tests and simplifications of basic maps "
+	"using at most <bytes> bytes. A value of 0 disables the cache.")
+ISL_ARG_BOOL(struct isl_options, tab_float_guide, 0, "tab-float-guide", 0,
+	"guide the exact simplex method using a floating point approximation")
+ISL_ARG_BOOL(struct isl_options, intersect_drop_redundant, 0,
+	"intersect-drop-redundant", 0, "check whether the constraints "
+	"added to a basic map without redundant constraints are redundant")
 ISL_ARG_BOOL(struct isl_options, print_stats, 0, "print-stats", 0,
 	"print statistics for every isl_ctx")
+ISL_ARG_BOOL(struct isl_options, stats_clock, 0, "stats-clock", 0,
+	"keep track of the processor time spent in some operations "
+	"in the statistics")
 ISL_ARG_ULONG(struct isl_options, max_operations, 0,
 	"max-operations", 0, "default number of maximal operations per isl_ctx")
 ISL_ARG_VERSION(print_version)
@@ -251,6 +275,31 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	coalesce_preserve_locals)
 
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intern_spaces)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intern_spaces)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	basic_map_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	basic_map_cache_size)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	tab_float_guide)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	tab_float_guide)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intersect_drop_redundant)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	intersect_drop_redundant)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	stats_clock)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	stats_clock)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	gbr_only_first)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
@@ -316,6 +365,21 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	schedule_serialize_sccs)
 
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_cache_slots)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_cache_slots)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_cache_max_entry_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_cache_max_entry_size)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_max_operations)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_max_operations)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	tile_scale_tile_loops)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
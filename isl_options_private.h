@@ -49,6 +49,9 @@ struct isl_options {
 	unsigned		schedule_algorithm;
 	int			schedule_carry_self_first;
 	int			schedule_serialize_sccs;
+	int			schedule_cache_slots;
+	int			schedule_cache_max_entry_size;
+	int			schedule_max_operations;
 
 	int			tile_scale_tile_loops;
 	int			tile_shift_point_loops;
@@ -68,7 +71,13 @@ struct isl_options {
 	int			ast_build_allow_else;
 	int			ast_build_allow_or;
 
+	int			intern_spaces;
+	int			basic_map_cache_size;
+	int			tab_float_guide;
+	int			intersect_drop_redundant;
+
 	int			print_stats;
+	int			stats_clock;
 	unsigned long		max_operations;
 };
 
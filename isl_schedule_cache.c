@@ -0,0 +1,465 @@
+/*
+ * Copyright 2026      Sven Verdoolaege
+ *
+ * Use of this software is governed by the MIT license
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <isl_config.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_options_private.h>
+#include <isl_schedule_constraints.h>
+#include <isl_sort.h>
+#include <isl/printer.h>
+#include <isl/schedule.h>
+#include <isl/set.h>
+#include <isl/map.h>
+#include <isl/union_set.h>
+#include <isl/union_map.h>
+#include <isl/version.h>
+#include <isl/hash.h>
+
+#include <set_to_map.c>
+
+/* The names of the schedule constraint types in the cache key,
+ * in the order of isl_edge_type.
+ */
+static const char *edge_name[] = {
+	"validity",
+	"coincidence",
+	"condition",
+	"conditional_validity",
+	"proximity",
+};
+
+/* Internal data structure for collecting the string representations
+ * of the elements of a union set or union map.
+ *
+ * "n" is the number of collected strings.
+ * "size" is the number of strings that fit in "str".
+ */
+struct isl_cache_key_data {
+	isl_ctx *ctx;
+	int n;
+	int size;
+	char **str;
+};
+
+/* Add "str" to data->str, taking ownership of "str".
+ */
+static isl_stat add_str(struct isl_cache_key_data *data, char *str)
+{
+	if (!str)
+		return isl_stat_error;
+	if (data->n >= data->size) {
+		int size = 2 * data->size + 4;
+		char **grown;
+
+		grown = isl_realloc_array(data->ctx, data->str, char *, size);
+		if (!grown) {
+			free(str);
+			return isl_stat_error;
+		}
+		data->str = grown;
+		data->size = size;
+	}
+	data->str[data->n++] = str;
+
+	return isl_stat_ok;
+}
+
+/* Add the string representation of a normalized form of "map" to "user".
+ * Maps that are equal up to the order of their disjuncts and
+ * their constraints have the same normalized form.
+ */
+static isl_stat add_map(__isl_take isl_map *map, void *user)
+{
+	struct isl_cache_key_data *data = user;
+	char *str;
+
+	map = isl_map_normalize(map);
+	str = isl_map_to_str(map);
+	isl_map_free(map);
+
+	return add_str(data, str);
+}
+
+/* Add the string representation of a normalized form of "set" to "user".
+ */
+static isl_stat add_set(__isl_take isl_set *set, void *user)
+{
+	return add_map(set_to_map(set), user);
+}
+
+/* Compare the strings pointed to by "a" and "b".
+ */
+static int cmp_str(const void *a, const void *b, void *user)
+{
+	char *const *str1 = a;
+	char *const *str2 = b;
+
+	return strcmp(*str1, *str2);
+}
+
+/* Print the strings collected in "data" in sorted order to "p"
+ * and free them.
+ * The order of the elements of a union depends on the order
+ * in which they were constructed, so it needs to be removed
+ * from the cache key.
+ */
+static __isl_give isl_printer *print_sorted(__isl_take isl_printer *p,
+	struct isl_cache_key_data *data)
+{
+	int i;
+
+	if (isl_sort(data->str, data->n, sizeof(char *), &cmp_str, NULL) < 0)
+		p = isl_printer_free(p);
+	p = isl_printer_print_str(p, "[");
+	for (i = 0; i < data->n; ++i) {
+		if (i)
+			p = isl_printer_print_str(p, "; ");
+		p = isl_printer_print_str(p, data->str[i]);
+		free(data->str[i]);
+	}
+	p = isl_printer_print_str(p, "]");
+	data->n = 0;
+
+	return p;
+}
+
+/* Print the values of the options that affect the result
+ * of isl_schedule_constraints_compute_schedule to "p".
+ */
+static __isl_give isl_printer *print_schedule_options(
+	__isl_take isl_printer *p, isl_ctx *ctx)
+{
+	struct isl_options *opt = ctx->opt;
+	char buf[200];
+
+	snprintf(buf, sizeof(buf), "options: %d %d %d %d %d %d %d %d %d %d "
+		"%u %d %d %d",
+		opt->schedule_max_coefficient,
+		opt->schedule_max_constant_term,
+		opt->schedule_parametric,
+		opt->schedule_outer_coincidence,
+		opt->schedule_maximize_band_depth,
+		opt->schedule_maximize_coincidence,
+		opt->schedule_split_scaled,
+		opt->schedule_treat_coalescing,
+		opt->schedule_separate_components,
+		opt->schedule_whole_component,
+		opt->schedule_algorithm,
+		opt->schedule_carry_self_first,
+		opt->schedule_serialize_sccs,
+		opt->schedule_max_operations);
+	return isl_printer_print_str(p, buf);
+}
+
+/* Return a canonical string representation of "sc" that can be used
+ * as a key in a schedule cache.
+ * The key includes the version of isl and the values
+ * of the scheduling options, since they affect the computed schedule.
+ * The elements of the domain and of each type of schedule constraints
+ * are normalized and sorted such that schedule constraints
+ * that only differ in the order in which they were constructed
+ * result in the same key.
+ * Since the key contains a full description of "sc",
+ * schedule constraints with the same key are equal.
+ */
+__isl_give char *isl_schedule_constraints_get_cache_key(
+	__isl_keep isl_schedule_constraints *sc)
+{
+	struct isl_cache_key_data data = { 0 };
+	enum isl_edge_type i;
+	isl_union_set *domain;
+	isl_set *context;
+	isl_printer *p;
+	isl_stat r;
+	char *key;
+
+	if (!sc)
+		return NULL;
+
+	data.ctx = isl_schedule_constraints_get_ctx(sc);
+	p = isl_printer_to_str(data.ctx);
+	p = isl_printer_print_str(p, isl_version());
+	p = isl_printer_print_str(p, "\n");
+	p = print_schedule_options(p, data.ctx);
+	p = isl_printer_print_str(p, "\ndomain: ");
+	domain = isl_schedule_constraints_get_domain(sc);
+	r = isl_union_set_foreach_set(domain, &add_set, &data);
+	isl_union_set_free(domain);
+	if (r < 0)
+		p = isl_printer_free(p);
+	p = print_sorted(p, &data);
+	p = isl_printer_print_str(p, "\ncontext: ");
+	context = isl_schedule_constraints_get_context(sc);
+	context = isl_set_normalize(context);
+	p = isl_printer_print_set(p, context);
+	isl_set_free(context);
+	for (i = isl_edge_first; i <= isl_edge_last; ++i) {
+		isl_union_map *c;
+
+		p = isl_printer_print_str(p, "\n");
+		p = isl_printer_print_str(p, edge_name[i]);
+		p = isl_printer_print_str(p, ": ");
+		c = isl_schedule_constraints_get(sc, i);
+		r = isl_union_map_foreach_map(c, &add_map, &data);
+		isl_union_map_free(c);
+		if (r < 0)
+			p = isl_printer_free(p);
+		p = print_sorted(p, &data);
+	}
+	p = isl_printer_print_str(p, "\n");
+	key = isl_printer_get_str(p);
+	isl_printer_free(p);
+
+	for (i = 0; i < data.n; ++i)
+		free(data.str[i]);
+	free(data.str);
+
+	return key;
+}
+
+/* Return the name of the file in directory "dir" that may contain
+ * the schedule for the cache key "key".
+ * The number of different file names is bounded by
+ * the schedule_cache_slots option, bounding the number
+ * of files in "dir".  Keys that map to the same file
+ * replace each other.
+ */
+static char *cache_file_name(isl_ctx *ctx, const char *dir, const char *key)
+{
+	uint32_t hash;
+	unsigned slot;
+	size_t len;
+	char *name;
+
+	hash = isl_hash_init();
+	hash = isl_hash_string(hash, key);
+	slot = hash % ctx->opt->schedule_cache_slots;
+	len = strlen(dir) + 40;
+	name = isl_alloc_array(ctx, char, len);
+	if (!name)
+		return NULL;
+	snprintf(name, len, "%s/isl-schedule-%u", dir, slot);
+
+	return name;
+}
+
+/* Read a schedule from "in" without reporting any error.
+ * If the schedule cannot be read, then NULL is returned and
+ * the error state of "ctx" is restored to what it was before the call.
+ */
+static __isl_give isl_schedule *read_schedule_silently(isl_ctx *ctx, FILE *in)
+{
+	int on_error;
+	enum isl_error error;
+	const char *msg, *file;
+	int line;
+	isl_schedule *schedule;
+
+	error = ctx->error;
+	msg = ctx->error_msg;
+	file = ctx->error_file;
+	line = ctx->error_line;
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	schedule = isl_schedule_read_from_file(ctx, in);
+	isl_options_set_on_error(ctx, on_error);
+	if (!schedule)
+		isl_ctx_set_full_error(ctx, error, msg, file, line);
+
+	return schedule;
+}
+
+/* Try and read the schedule for the cache key "key" from the file "name".
+ * The file starts with the length of the key on a line by itself,
+ * followed by the key and the schedule.
+ * Return NULL if the file does not exist,
+ * if it contains the schedule for a different key or
+ * if the schedule cannot be read, e.g., because the file is corrupt.
+ * In all these cases, the schedule is simply recomputed.
+ */
+static __isl_give isl_schedule *cache_load(isl_ctx *ctx, const char *name,
+	const char *key)
+{
+	FILE *in;
+	unsigned long n;
+	size_t len;
+	char *stored;
+	int match;
+	isl_schedule *schedule;
+
+	in = fopen(name, "rb");
+	if (!in)
+		return NULL;
+
+	len = strlen(key);
+	if (fscanf(in, "%lu", &n) != 1 || n != len || fgetc(in) != '\n') {
+		fclose(in);
+		return NULL;
+	}
+	stored = isl_alloc_array(ctx, char, len);
+	match = stored && fread(stored, 1, len, in) == len &&
+		memcmp(stored, key, len) == 0;
+	free(stored);
+	if (!match) {
+		fclose(in);
+		return NULL;
+	}
+	schedule = read_schedule_silently(ctx, in);
+	fclose(in);
+
+	return schedule;
+}
+
+/* Create and open a new temporary file for writing an entry
+ * that is meant to be stored in the file "name".
+ * The name of the temporary file is returned in "tmp".
+ * The temporary file is created in the same directory as "name",
+ * such that it can be moved into place by rename.
+ *
+ * If mkstemp is available, then it is used to create
+ * a temporary file that is guaranteed not to exist yet.
+ * Otherwise, the name of the temporary file is made unique by including
+ * the process identifier (if available), the address of "ctx" and
+ * the number of temporary files created through "ctx" so far,
+ * such that concurrent writers, whether in different processes or
+ * in different threads of the same process (each using their own isl_ctx),
+ * do not write to the same temporary file.
+ */
+static FILE *open_tmp(isl_ctx *ctx, const char *name, char **tmp)
+{
+	size_t len;
+	FILE *out;
+#ifdef HAVE_MKSTEMP
+	int fd;
+#else
+	unsigned long pid = 0;
+#endif
+
+	len = strlen(name) + 80;
+	*tmp = isl_alloc_array(ctx, char, len);
+	if (!*tmp)
+		return NULL;
+#ifdef HAVE_MKSTEMP
+	snprintf(*tmp, len, "%s.XXXXXX", name);
+	fd = mkstemp(*tmp);
+	if (fd < 0)
+		return NULL;
+	out = fdopen(fd, "wb");
+	if (!out) {
+		close(fd);
+		remove(*tmp);
+	}
+#else
+#ifdef HAVE_UNISTD_H
+	pid = getpid();
+#endif
+	snprintf(*tmp, len, "%s.%lu.%p.%lu.tmp", name, pid, (void *) ctx,
+		ctx->n_cache_tmp++);
+	out = fopen(*tmp, "wb");
+#endif
+
+	return out;
+}
+
+/* Store "schedule" in the file "name" under the cache key "key",
+ * provided the result is not larger than allowed by
+ * the schedule_cache_max_entry_size option.
+ * The entry is first written to a temporary file, which is then
+ * moved into place, such that concurrent readers never see
+ * a partially written entry.
+ * Failure to store the entry is not considered to be an error.
+ */
+static void cache_store(isl_ctx *ctx, const char *name, const char *key,
+	__isl_keep isl_schedule *schedule)
+{
+	FILE *out;
+	char *str;
+	char *tmp = NULL;
+	size_t len;
+	int max = ctx->opt->schedule_cache_max_entry_size;
+	int ok;
+
+	str = isl_schedule_to_str(schedule);
+	if (!str)
+		return;
+	len = strlen(key) + strlen(str) + 22;
+	if (max >= 0 && len > (size_t) max) {
+		free(str);
+		return;
+	}
+
+	out = open_tmp(ctx, name, &tmp);
+	if (out) {
+		ok = fprintf(out, "%lu\n%s%s\n",
+			    (unsigned long) strlen(key), key, str) >= 0;
+		ok = fclose(out) == 0 && ok;
+		if (ok && rename(tmp, name) != 0) {
+			remove(name);
+			ok = rename(tmp, name) == 0;
+		}
+		if (!ok)
+			remove(tmp);
+	}
+	free(tmp);
+	free(str);
+}
+
+/* Compute a schedule for "sc", using the on-disk schedule cache
+ * in directory "dir".
+ * If the cache contains a schedule for schedule constraints
+ * with the same cache key, then this schedule is returned directly.
+ * Otherwise, the schedule is computed and stored in the cache.
+ * The cache is disabled if the schedule_cache_slots option
+ * is not positive.
+ */
+__isl_give isl_schedule *isl_schedule_constraints_compute_schedule_cached(
+	__isl_take isl_schedule_constraints *sc, const char *dir)
+{
+	isl_ctx *ctx;
+	char *key;
+	char *name;
+	isl_schedule *schedule;
+
+	if (!sc)
+		return NULL;
+	ctx = isl_schedule_constraints_get_ctx(sc);
+	if (!dir)
+		isl_die(ctx, isl_error_invalid, "no cache directory specified",
+			goto error);
+	if (ctx->opt->schedule_cache_slots <= 0)
+		return isl_schedule_constraints_compute_schedule(sc);
+
+	key = isl_schedule_constraints_get_cache_key(sc);
+	name = key ? cache_file_name(ctx, dir, key) : NULL;
+	if (!name) {
+		free(key);
+		goto error;
+	}
+
+	schedule = cache_load(ctx, name, key);
+	if (schedule) {
+		isl_schedule_constraints_free(sc);
+	} else {
+		schedule = isl_schedule_constraints_compute_schedule(sc);
+		if (schedule)
+			cache_store(ctx, name, key, schedule);
+	}
+
+	free(name);
+	free(key);
+	return schedule;
+error:
+	isl_schedule_constraints_free(sc);
+	return NULL;
+}
@@ -15,6 +15,7 @@
  * CS 42112, 75589 Paris Cedex 12, France
  */
 
+#include <time.h>
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_space_private.h>
@@ -472,10 +473,6 @@ static isl_stat graph_alloc(isl_ctx *ctx, struct isl_sched_graph *graph,
 	graph->edge = isl_calloc_array(ctx,
 					struct isl_sched_edge, graph->n_edge);
 
-	graph->intra_hmap = isl_map_to_basic_set_alloc(ctx, 2 * n_edge);
-	graph->intra_hmap_param = isl_map_to_basic_set_alloc(ctx, 2 * n_edge);
-	graph->inter_hmap = isl_map_to_basic_set_alloc(ctx, 2 * n_edge);
-
 	if (!graph->node || !graph->region || (graph->n_edge && !graph->edge) ||
 	    !graph->sorted)
 		return isl_stat_error;
@@ -1380,6 +1377,12 @@ isl_stat isl_sched_graph_init(struct isl_sched_graph *graph,
 	if (compute_max_row(graph, sc) < 0)
 		return isl_stat_error;
 	graph->root = graph;
+	graph->intra_hmap = isl_map_to_basic_set_alloc(ctx, 2 * n);
+	graph->intra_hmap_param = isl_map_to_basic_set_alloc(ctx, 2 * n);
+	graph->inter_hmap = isl_map_to_basic_set_alloc(ctx, 2 * n);
+	if (!graph->intra_hmap || !graph->intra_hmap_param ||
+	    !graph->inter_hmap)
+		return isl_stat_error;
 	graph->n = 0;
 	domain = isl_schedule_constraints_get_domain(sc);
 	domain = isl_union_set_intersect_params(domain,
@@ -1627,6 +1630,16 @@ static __isl_give isl_set *drop_coalescing_constraints(
  *
  * If "node" has been compressed, then the dependence relation
  * is also compressed before the set of coefficients is computed.
+ *
+ * The caches are kept in the root dependence graph such that
+ * the coefficients of a dependence relation are computed only once,
+ * even if the relation appears in several subgraphs,
+ * e.g., after splitting the graph into components or during clustering.
+ * The result only depends on the dependence relation and on properties
+ * of "node" that are shared by all these graphs.
+ * A failed computation is not recorded in the cache, such that
+ * the cache remains available to the fallbacks in compute_schedule_wcc
+ * when a computation is interrupted because its budget is exhausted.
  */
 static __isl_give isl_basic_set *intra_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_node *node,
@@ -1637,7 +1650,7 @@ static __isl_give isl_basic_set *intra_coefficients(
 	isl_map *key;
 	isl_basic_set *coef;
 	isl_maybe_isl_basic_set m;
-	isl_map_to_basic_set **hmap = &graph->intra_hmap;
+	isl_map_to_basic_set **hmap = &graph->root->intra_hmap;
 	int treat;
 
 	if (!map)
@@ -1646,7 +1659,7 @@ static __isl_give isl_basic_set *intra_coefficients(
 	ctx = isl_map_get_ctx(map);
 	treat = !need_param && isl_options_get_schedule_treat_coalescing(ctx);
 	if (!treat)
-		hmap = &graph->intra_hmap_param;
+		hmap = &graph->root->intra_hmap_param;
 	m = isl_map_to_basic_set_try_get(*hmap, map);
 	if (m.valid < 0 || m.valid) {
 		isl_map_free(map);
@@ -1660,7 +1673,11 @@ static __isl_give isl_basic_set *intra_coefficients(
 		delta = drop_coalescing_constraints(delta, node);
 	delta = isl_set_remove_divs(delta);
 	coef = isl_set_coefficients(delta);
-	*hmap = isl_map_to_basic_set_set(*hmap, key, isl_basic_set_copy(coef));
+	if (coef)
+		*hmap = isl_map_to_basic_set_set(*hmap, key,
+						isl_basic_set_copy(coef));
+	else
+		isl_map_free(key);
 
 	return coef;
 }
@@ -1675,6 +1692,9 @@ static __isl_give isl_basic_set *intra_coefficients(
  * If the source or destination nodes of "edge" have been compressed,
  * then the dependence relation is also compressed before
  * the set of coefficients is computed.
+ *
+ * As in intra_coefficients, the cache is kept in the root dependence graph
+ * and failed computations are not recorded.
  */
 static __isl_give isl_basic_set *inter_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_edge *edge,
@@ -1685,7 +1705,7 @@ static __isl_give isl_basic_set *inter_coefficients(
 	isl_basic_set *coef;
 	isl_maybe_isl_basic_set m;
 
-	m = isl_map_to_basic_set_try_get(graph->inter_hmap, map);
+	m = isl_map_to_basic_set_try_get(graph->root->inter_hmap, map);
 	if (m.valid < 0 || m.valid) {
 		isl_map_free(map);
 		return m.value;
@@ -1695,8 +1715,11 @@ static __isl_give isl_basic_set *inter_coefficients(
 	map = compress(map, edge->src, edge->dst);
 	set = isl_map_wrap(isl_map_remove_divs(map));
 	coef = isl_set_coefficients(set);
-	graph->inter_hmap = isl_map_to_basic_set_set(graph->inter_hmap, key,
-					isl_basic_set_copy(coef));
+	if (coef)
+		graph->root->inter_hmap = isl_map_to_basic_set_set(
+			graph->root->inter_hmap, key, isl_basic_set_copy(coef));
+	else
+		isl_map_free(key);
 
 	return coef;
 }
@@ -2908,7 +2931,10 @@ static __isl_give isl_vec *solve_lp(isl_ctx *ctx, struct isl_sched_graph *graph)
 	int i;
 	isl_vec *sol;
 	isl_basic_set *lp;
+	clock_t start;
 
+	ctx->stats->sched_lp++;
+	start = isl_ctx_clock(ctx);
 	for (i = 0; i < graph->n; ++i) {
 		struct isl_sched_node *node = &graph->node[i];
 		isl_mat *trivial;
@@ -2925,6 +2951,7 @@ static __isl_give isl_vec *solve_lp(isl_ctx *ctx, struct isl_sched_graph *graph)
 				       graph->region, &check_conflict, graph);
 	for (i = 0; i < graph->n; ++i)
 		isl_mat_free(graph->region[i].trivial);
+	ctx->stats->sched_lp_clock += isl_ctx_clock(ctx) - start;
 	return sol;
 }
 
@@ -3485,6 +3512,39 @@ static __isl_give isl_union_set_list *extract_split(isl_ctx *ctx,
 	return filters;
 }
 
+/* Append a copy of "node" to the dst dependence graph.
+ */
+static isl_stat copy_node(struct isl_sched_graph *dst,
+	struct isl_sched_node *node)
+{
+	int j;
+
+	j = dst->n;
+	dst->node[j].space = isl_space_copy(node->space);
+	dst->node[j].compressed = node->compressed;
+	dst->node[j].hull = isl_set_copy(node->hull);
+	dst->node[j].compress = isl_multi_aff_copy(node->compress);
+	dst->node[j].decompress = isl_pw_multi_aff_copy(node->decompress);
+	dst->node[j].nvar = node->nvar;
+	dst->node[j].nparam = node->nparam;
+	dst->node[j].sched = isl_mat_copy(node->sched);
+	dst->node[j].sched_map = isl_map_copy(node->sched_map);
+	dst->node[j].coincident = node->coincident;
+	dst->node[j].sizes = isl_multi_val_copy(node->sizes);
+	dst->node[j].bounds = isl_basic_set_copy(node->bounds);
+	dst->node[j].max = isl_vec_copy(node->max);
+	dst->n++;
+
+	if (!dst->node[j].space || !dst->node[j].sched)
+		return isl_stat_error;
+	if (dst->node[j].compressed &&
+	    (!dst->node[j].hull || !dst->node[j].compress ||
+	     !dst->node[j].decompress))
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
 /* Copy nodes that satisfy node_pred from the src dependence graph
  * to the dst dependence graph.
  */
@@ -3496,46 +3556,69 @@ static isl_stat copy_nodes(struct isl_sched_graph *dst,
 
 	dst->n = 0;
 	for (i = 0; i < src->n; ++i) {
-		int j;
-
 		if (!node_pred(&src->node[i], data))
 			continue;
-
-		j = dst->n;
-		dst->node[j].space = isl_space_copy(src->node[i].space);
-		dst->node[j].compressed = src->node[i].compressed;
-		dst->node[j].hull = isl_set_copy(src->node[i].hull);
-		dst->node[j].compress =
-			isl_multi_aff_copy(src->node[i].compress);
-		dst->node[j].decompress =
-			isl_pw_multi_aff_copy(src->node[i].decompress);
-		dst->node[j].nvar = src->node[i].nvar;
-		dst->node[j].nparam = src->node[i].nparam;
-		dst->node[j].sched = isl_mat_copy(src->node[i].sched);
-		dst->node[j].sched_map = isl_map_copy(src->node[i].sched_map);
-		dst->node[j].coincident = src->node[i].coincident;
-		dst->node[j].sizes = isl_multi_val_copy(src->node[i].sizes);
-		dst->node[j].bounds = isl_basic_set_copy(src->node[i].bounds);
-		dst->node[j].max = isl_vec_copy(src->node[i].max);
-		dst->n++;
-
-		if (!dst->node[j].space || !dst->node[j].sched)
-			return isl_stat_error;
-		if (dst->node[j].compressed &&
-		    (!dst->node[j].hull || !dst->node[j].compress ||
-		     !dst->node[j].decompress))
+		if (copy_node(dst, &src->node[i]) < 0)
 			return isl_stat_error;
 	}
 
 	return isl_stat_ok;
 }
 
-/* Copy non-empty edges that satisfy edge_pred from the src dependence graph
- * to the dst dependence graph.
+/* Append a copy of "edge" to the dst dependence graph,
+ * unless it is empty.
  * If the source or destination node of the edge is not in the destination
  * graph, then it must be a backward proximity edge and it should simply
  * be ignored.
  */
+static isl_stat copy_edge(isl_ctx *ctx, struct isl_sched_graph *dst,
+	struct isl_sched_edge *edge)
+{
+	isl_map *map;
+	isl_union_map *tagged_condition;
+	isl_union_map *tagged_validity;
+	struct isl_sched_node *dst_src, *dst_dst;
+
+	if (isl_map_plain_is_empty(edge->map))
+		return isl_stat_ok;
+
+	dst_src = isl_sched_graph_find_node(ctx, dst, edge->src->space);
+	dst_dst = isl_sched_graph_find_node(ctx, dst, edge->dst->space);
+	if (!dst_src || !dst_dst)
+		return isl_stat_error;
+	if (!isl_sched_graph_is_node(dst, dst_src) ||
+	    !isl_sched_graph_is_node(dst, dst_dst)) {
+		if (is_validity(edge) ||
+		    isl_sched_edge_is_conditional_validity(edge))
+			isl_die(ctx, isl_error_internal,
+				"backward (conditional) validity edge",
+				return isl_stat_error);
+		return isl_stat_ok;
+	}
+
+	map = isl_map_copy(edge->map);
+	tagged_condition = isl_union_map_copy(edge->tagged_condition);
+	tagged_validity = isl_union_map_copy(edge->tagged_validity);
+
+	dst->edge[dst->n_edge].src = dst_src;
+	dst->edge[dst->n_edge].dst = dst_dst;
+	dst->edge[dst->n_edge].map = map;
+	dst->edge[dst->n_edge].tagged_condition = tagged_condition;
+	dst->edge[dst->n_edge].tagged_validity = tagged_validity;
+	dst->edge[dst->n_edge].types = edge->types;
+	dst->n_edge++;
+
+	if (edge->tagged_condition && !tagged_condition)
+		return isl_stat_error;
+	if (edge->tagged_validity && !tagged_validity)
+		return isl_stat_error;
+
+	return graph_edge_tables_add(ctx, dst, &dst->edge[dst->n_edge - 1]);
+}
+
+/* Copy non-empty edges that satisfy edge_pred from the src dependence graph
+ * to the dst dependence graph.
+ */
 static isl_stat copy_edges(isl_ctx *ctx, struct isl_sched_graph *dst,
 	struct isl_sched_graph *src,
 	int (*edge_pred)(struct isl_sched_edge *edge, int data), int data)
@@ -3544,51 +3627,9 @@ static isl_stat copy_edges(isl_ctx *ctx, struct isl_sched_graph *dst,
 
 	dst->n_edge = 0;
 	for (i = 0; i < src->n_edge; ++i) {
-		struct isl_sched_edge *edge = &src->edge[i];
-		isl_map *map;
-		isl_union_map *tagged_condition;
-		isl_union_map *tagged_validity;
-		struct isl_sched_node *dst_src, *dst_dst;
-
-		if (!edge_pred(edge, data))
-			continue;
-
-		if (isl_map_plain_is_empty(edge->map))
-			continue;
-
-		dst_src = isl_sched_graph_find_node(ctx, dst, edge->src->space);
-		dst_dst = isl_sched_graph_find_node(ctx, dst, edge->dst->space);
-		if (!dst_src || !dst_dst)
-			return isl_stat_error;
-		if (!isl_sched_graph_is_node(dst, dst_src) ||
-		    !isl_sched_graph_is_node(dst, dst_dst)) {
-			if (is_validity(edge) ||
-			    isl_sched_edge_is_conditional_validity(edge))
-				isl_die(ctx, isl_error_internal,
-					"backward (conditional) validity edge",
-					return isl_stat_error);
+		if (!edge_pred(&src->edge[i], data))
 			continue;
-		}
-
-		map = isl_map_copy(edge->map);
-		tagged_condition = isl_union_map_copy(edge->tagged_condition);
-		tagged_validity = isl_union_map_copy(edge->tagged_validity);
-
-		dst->edge[dst->n_edge].src = dst_src;
-		dst->edge[dst->n_edge].dst = dst_dst;
-		dst->edge[dst->n_edge].map = map;
-		dst->edge[dst->n_edge].tagged_condition = tagged_condition;
-		dst->edge[dst->n_edge].tagged_validity = tagged_validity;
-		dst->edge[dst->n_edge].types = edge->types;
-		dst->n_edge++;
-
-		if (edge->tagged_condition && !tagged_condition)
-			return isl_stat_error;
-		if (edge->tagged_validity && !tagged_validity)
-			return isl_stat_error;
-
-		if (graph_edge_tables_add(ctx, dst,
-					    &dst->edge[dst->n_edge - 1]) < 0)
+		if (copy_edge(ctx, dst, &src->edge[i]) < 0)
 			return isl_stat_error;
 	}
 
@@ -3661,6 +3702,78 @@ isl_stat isl_sched_graph_extract_sub_graph(isl_ctx *ctx,
 	return isl_stat_ok;
 }
 
+/* Extract the subgraphs of "graph" that consist of the nodes
+ * of each of the graph->scc groups identified by node->scc,
+ * along with the edges between nodes of the same group,
+ * and store the result in sub[0], ..., sub[graph->scc - 1].
+ * The result is the same as that of calling
+ * isl_sched_graph_extract_sub_graph with isl_sched_node_scc_exactly and
+ * isl_sched_edge_scc_exactly on each group, but the nodes and
+ * edges of "graph" are only traversed once in total rather than
+ * once per group, which matters if there are many small groups.
+ * The caller is responsible for freeing the elements of "sub",
+ * which are assumed to have been initialized to zero.
+ */
+isl_stat isl_sched_graph_extract_components(isl_ctx *ctx,
+	struct isl_sched_graph *graph, struct isl_sched_graph *sub)
+{
+	int i, t;
+	int *n_node, *n_edge;
+
+	n_node = isl_calloc_array(ctx, int, graph->scc);
+	n_edge = isl_calloc_array(ctx, int, graph->scc);
+	if (!n_node || !n_edge)
+		goto error;
+
+	for (i = 0; i < graph->n; ++i)
+		n_node[graph->node[i].scc]++;
+	for (i = 0; i < graph->n_edge; ++i) {
+		struct isl_sched_edge *edge = &graph->edge[i];
+
+		if (edge->src->scc == edge->dst->scc)
+			n_edge[edge->src->scc]++;
+	}
+
+	for (i = 0; i < graph->scc; ++i) {
+		if (graph_alloc(ctx, &sub[i], n_node[i], n_edge[i]) < 0)
+			goto error;
+		sub[i].root = graph->root;
+		sub[i].n = 0;
+		sub[i].n_edge = 0;
+	}
+	for (i = 0; i < graph->n; ++i)
+		if (copy_node(&sub[graph->node[i].scc], &graph->node[i]) < 0)
+			goto error;
+	for (i = 0; i < graph->scc; ++i) {
+		if (graph_init_table(ctx, &sub[i]) < 0)
+			goto error;
+		for (t = 0; t <= isl_edge_last; ++t)
+			sub[i].max_edge[t] = graph->max_edge[t];
+		if (graph_init_edge_tables(ctx, &sub[i]) < 0)
+			goto error;
+		sub[i].n_row = graph->n_row;
+		sub[i].max_row = graph->max_row;
+		sub[i].n_total_row = graph->n_total_row;
+		sub[i].band_start = graph->band_start;
+	}
+	for (i = 0; i < graph->n_edge; ++i) {
+		struct isl_sched_edge *edge = &graph->edge[i];
+
+		if (edge->src->scc != edge->dst->scc)
+			continue;
+		if (copy_edge(ctx, &sub[edge->src->scc], edge) < 0)
+			goto error;
+	}
+
+	free(n_node);
+	free(n_edge);
+	return isl_stat_ok;
+error:
+	free(n_node);
+	free(n_edge);
+	return isl_stat_error;
+}
+
 static __isl_give isl_schedule_node *compute_schedule(isl_schedule_node *node,
 	struct isl_sched_graph *graph);
 static __isl_give isl_schedule_node *compute_schedule_wcc(
@@ -4505,8 +4618,16 @@ static __isl_give isl_tab_lexmin *zero_out_node_coef(
 static __isl_give isl_vec *non_empty_solution(__isl_keep isl_tab_lexmin *tl)
 {
 	isl_vec *sol;
+	isl_ctx *ctx;
+	clock_t start;
 
+	ctx = isl_tab_lexmin_get_ctx(tl);
+	if (!ctx)
+		return NULL;
+	ctx->stats->sched_lp++;
+	start = isl_ctx_clock(ctx);
 	sol = isl_tab_lexmin_get_solution(tl);
+	ctx->stats->sched_lp_clock += isl_ctx_clock(ctx) - start;
 	if (!sol)
 		return NULL;
 	if (sol->size == 0)
@@ -5340,7 +5461,8 @@ static int has_validity_edges(struct isl_sched_graph *graph)
  */
 static int need_feautrier_step(isl_ctx *ctx, struct isl_sched_graph *graph)
 {
-	if (ctx->opt->schedule_algorithm != ISL_SCHEDULE_ALGORITHM_FEAUTRIER)
+	if (!graph->root->feautrier &&
+	    ctx->opt->schedule_algorithm != ISL_SCHEDULE_ALGORITHM_FEAUTRIER)
 		return 0;
 
 	return has_validity_edges(graph);
@@ -5740,8 +5862,8 @@ static __isl_give isl_schedule_node *compute_schedule_wcc_whole(
 	return isl_schedule_node_compute_finish_band(node, graph, 1);
 }
 
-/* Compute a schedule for a connected dependence graph and return
- * the updated schedule node.
+/* Compute a schedule for a connected dependence graph using
+ * the selected scheduling algorithm and return the updated schedule node.
  *
  * If Feautrier's algorithm is selected, we first recursively try to satisfy
  * as many validity dependences as possible. When all validity dependences
@@ -5755,7 +5877,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc_whole(
  * in isl_schedule_node_compute_wcc_clustering, so compute_schedule_wcc_whole
  * is called instead.
  */
-static __isl_give isl_schedule_node *compute_schedule_wcc(
+static __isl_give isl_schedule_node *compute_schedule_wcc_algorithm(
 	__isl_take isl_schedule_node *node, struct isl_sched_graph *graph)
 {
 	isl_ctx *ctx;
@@ -5779,15 +5901,327 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 		return isl_schedule_node_compute_wcc_clustering(node, graph);
 }
 
+/* Return 1 for any node of the graph.
+ * Used to extract a copy of the graph.
+ */
+static int node_any(struct isl_sched_node *node, int data)
+{
+	return 1;
+}
+
+/* Return 1 for any edge of the graph.
+ * Used to extract a copy of the graph.
+ */
+static int edge_any(struct isl_sched_edge *edge, int data)
+{
+	return 1;
+}
+
+/* Allow "budget" more operations to be performed in "ctx",
+ * without exceeding the bound "max" that was set by the user, if any.
+ */
+static void set_budget(isl_ctx *ctx, unsigned long max, int budget)
+{
+	unsigned long bound;
+
+	bound = ctx->operations + budget;
+	if (max && max < bound)
+		bound = max;
+	isl_ctx_set_max_operations(ctx, bound);
+}
+
+/* Did the last computation in "ctx" fail because it exceeded
+ * the budget set by set_budget rather than the bound "max"
+ * that was set by the user or because of any other error?
+ * If so, then reset the error such that the computation
+ * can continue with a fallback.
+ */
+static int budget_exhausted(isl_ctx *ctx, unsigned long max)
+{
+	if (isl_ctx_last_error(ctx) != isl_error_quota)
+		return 0;
+	if (max && ctx->operations >= max)
+		return 0;
+	isl_ctx_reset_error(ctx);
+	return 1;
+}
+
+/* Try and compute a schedule for a copy of the connected dependence
+ * graph "graph" using at most ctx->opt->schedule_max_operations operations
+ * and insert it at position "node".
+ * If "feautrier" is set, then use Feautrier's algorithm, irrespective
+ * of the schedule_algorithm option.
+ * "max" is the bound on the number of operations set by the user.
+ *
+ * The computation is performed on a copy since a failed attempt
+ * may leave "graph" in an inconsistent state.
+ * Any schedule computations on subgraphs performed by this attempt
+ * are subject to the same budget.
+ * The budget is enforced through the operation counter of "ctx",
+ * which counts tableau pivots and memory allocations, and
+ * exhausting it is signaled through an isl_error_quota error.
+ * The on_error option is therefore temporarily set to continue
+ * such that this error is not printed and does not abort.
+ * Any other error is reported after restoring the on_error option.
+ * Return the updated schedule node or NULL on failure.
+ * In the latter case, *exhausted is set if the failure
+ * is due to the budget being exceeded.
+ */
+static __isl_give isl_schedule_node *compute_schedule_wcc_try(
+	__isl_keep isl_schedule_node *node, struct isl_sched_graph *graph,
+	int feautrier, unsigned long max, int *exhausted)
+{
+	isl_ctx *ctx;
+	int on_error;
+	struct isl_sched_graph copy = { 0 };
+
+	*exhausted = 0;
+	ctx = isl_schedule_node_get_ctx(node);
+	if (isl_sched_graph_extract_sub_graph(ctx, graph, &node_any, &edge_any,
+						0, &copy) < 0) {
+		isl_sched_graph_free(ctx, &copy);
+		return NULL;
+	}
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	set_budget(ctx, max, ctx->opt->schedule_max_operations);
+	graph->root->budget = 1;
+	graph->root->feautrier = feautrier;
+	node = compute_schedule_wcc_algorithm(isl_schedule_node_copy(node),
+						&copy);
+	graph->root->budget = 0;
+	graph->root->feautrier = 0;
+	isl_ctx_set_max_operations(ctx, max);
+	isl_options_set_on_error(ctx, on_error);
+
+	isl_sched_graph_free(ctx, &copy);
+	if (!node)
+		*exhausted = budget_exhausted(ctx, max);
+	if (!node && !*exhausted && isl_ctx_last_error(ctx) != isl_error_none)
+		isl_handle_error(ctx, isl_ctx_last_error(ctx),
+			isl_ctx_last_error_msg(ctx),
+			isl_ctx_last_error_file(ctx),
+			isl_ctx_last_error_line(ctx));
+	return node;
+}
+
+/* Construct a schedule for the nodes in "graph" that executes
+ * the strongly connected components in the order of graph->node[i].scc
+ * and the instances of each node in the lexicographic order
+ * of its variables.
+ * That is, the schedule of each node has the form
+ *
+ *	[i_0, ..., i_{n-1}] -> [scc, i_0, ..., i_{n-1}, 0, ..., 0]
+ *
+ * where the trailing zeros pad the schedule to the maximal number
+ * of variables of any node.
+ * The schedule is constructed without solving any (I)LP problems.
+ */
+static __isl_give isl_union_pw_multi_aff *identity_schedule(isl_ctx *ctx,
+	struct isl_sched_graph *graph)
+{
+	int i, j;
+	isl_size n, max_dim = 0;
+	isl_union_pw_multi_aff *upma;
+
+	for (i = 0; i < graph->n; ++i) {
+		n = isl_space_dim(graph->node[i].space, isl_dim_set);
+		if (n < 0)
+			return NULL;
+		if (n > max_dim)
+			max_dim = n;
+	}
+
+	upma = isl_union_pw_multi_aff_empty_ctx(ctx);
+	for (i = 0; i < graph->n; ++i) {
+		struct isl_sched_node *node = &graph->node[i];
+		isl_space *space, *range;
+		isl_multi_aff *ma;
+		isl_aff *aff;
+
+		n = isl_space_dim(node->space, isl_dim_set);
+		space = isl_space_copy(node->space);
+		range = isl_space_params(isl_space_copy(space));
+		range = isl_space_set_from_params(range);
+		range = isl_space_add_dims(range, isl_dim_set, 1 + max_dim);
+		space = isl_space_map_from_domain_and_range(space, range);
+		ma = isl_multi_aff_zero(space);
+		aff = isl_multi_aff_get_aff(ma, 0);
+		aff = isl_aff_add_constant_si(aff, node->scc);
+		ma = isl_multi_aff_set_aff(ma, 0, aff);
+		for (j = 0; j < n; ++j) {
+			isl_local_space *ls;
+
+			ls = isl_local_space_from_space(
+					isl_space_copy(node->space));
+			aff = isl_aff_var_on_domain(ls, isl_dim_set, j);
+			ma = isl_multi_aff_set_aff(ma, 1 + j, aff);
+		}
+		upma = isl_union_pw_multi_aff_add_pw_multi_aff(upma,
+					isl_pw_multi_aff_from_multi_aff(ma));
+	}
+
+	return upma;
+}
+
+/* Does the schedule "upma" respect all (conditional) validity
+ * constraints in "graph"?
+ * Conditional validity constraints are treated as validity constraints
+ * since checking whether they need to be respected would require
+ * information about the adjacency of the condition constraints.
+ */
+static isl_bool respects_validity(struct isl_sched_graph *graph,
+	__isl_keep isl_union_pw_multi_aff *upma)
+{
+	int i;
+	isl_union_map *umap, *lt;
+	isl_bool ok = isl_bool_true;
+
+	umap = isl_union_map_from_union_pw_multi_aff(
+					isl_union_pw_multi_aff_copy(upma));
+	lt = isl_union_map_lex_lt_union_map(isl_union_map_copy(umap), umap);
+	for (i = 0; ok == isl_bool_true && i < graph->n_edge; ++i) {
+		struct isl_sched_edge *edge = &graph->edge[i];
+		isl_union_map *dep;
+
+		if (!is_any_validity(edge))
+			continue;
+		dep = isl_union_map_from_map(isl_map_copy(edge->map));
+		ok = isl_union_map_is_subset(dep, lt);
+		isl_union_map_free(dep);
+	}
+	isl_union_map_free(lt);
+
+	return ok;
+}
+
+/* Insert the schedule constructed by identity_schedule for "graph"
+ * at position "node", provided it respects the validity constraints.
+ * Return the updated schedule node, or a copy of "node" along with
+ * *valid set to 0 if the schedule does not respect them.
+ *
+ * The strongly connected components are detected on a copy of "graph"
+ * since "graph" may still be needed for computing a schedule
+ * using the selected algorithm and detect_sccs modifies the graph.
+ */
+static __isl_give isl_schedule_node *insert_identity_schedule(
+	__isl_keep isl_schedule_node *node, struct isl_sched_graph *graph,
+	int *valid)
+{
+	isl_ctx *ctx;
+	struct isl_sched_graph copy = { 0 };
+	isl_union_pw_multi_aff *upma;
+	isl_multi_union_pw_aff *mupa;
+	isl_bool ok;
+
+	ctx = isl_schedule_node_get_ctx(node);
+	*valid = 0;
+	if (isl_sched_graph_extract_sub_graph(ctx, graph, &node_any, &edge_any,
+						0, &copy) < 0 ||
+	    detect_sccs(ctx, &copy) < 0) {
+		isl_sched_graph_free(ctx, &copy);
+		return NULL;
+	}
+	upma = identity_schedule(ctx, &copy);
+	ok = respects_validity(&copy, upma);
+	isl_sched_graph_free(ctx, &copy);
+	if (ok < 0) {
+		isl_union_pw_multi_aff_free(upma);
+		return NULL;
+	}
+	node = isl_schedule_node_copy(node);
+	if (!ok) {
+		isl_union_pw_multi_aff_free(upma);
+		return node;
+	}
+	*valid = 1;
+	mupa = isl_multi_union_pw_aff_from_union_pw_multi_aff(upma);
+	return isl_schedule_node_insert_partial_schedule(node, mupa);
+}
+
+/* Compute a schedule for a connected dependence graph and return
+ * the updated schedule node.
+ *
+ * If the schedule_max_operations option is set and if this graph
+ * is not being scheduled as part of an outer computation
+ * that is already subject to a budget, then the schedule is first
+ * computed using the selected algorithm, but subject to
+ * the given number of operations.
+ * If this budget is exhausted, then fall back to Feautrier's algorithm,
+ * with a fresh budget, since it usually requires fewer (I)LP problems
+ * to be solved.  There is no point in trying Feautrier's algorithm
+ * if there are no validity constraints, since it would then reduce
+ * to the default algorithm.
+ * If this budget is exhausted as well, then try the schedule
+ * constructed by identity_schedule, which does not require
+ * solving any (I)LP problem.
+ * If even that schedule does not respect the validity constraints,
+ * then there is no cheap way of obtaining a valid schedule and
+ * the schedule is computed using the selected algorithm
+ * without budget.
+ * The bound on the number of operations set by the user, if any,
+ * remains in force throughout.
+ */
+static __isl_give isl_schedule_node *compute_schedule_wcc(
+	__isl_take isl_schedule_node *node, struct isl_sched_graph *graph)
+{
+	isl_ctx *ctx;
+	unsigned long max;
+	int exhausted, validity, valid;
+	isl_schedule_node *res;
+
+	if (!node)
+		return NULL;
+
+	ctx = isl_schedule_node_get_ctx(node);
+	if (ctx->opt->schedule_max_operations <= 0 || graph->root->budget)
+		return compute_schedule_wcc_algorithm(node, graph);
+
+	max = isl_ctx_get_max_operations(ctx);
+	res = compute_schedule_wcc_try(node, graph, 0, max, &exhausted);
+	if (res || !exhausted)
+		goto done;
+
+	ctx->stats->sched_fallback++;
+	validity = has_validity_edges(graph);
+	if (validity < 0)
+		goto done;
+	if (validity) {
+		res = compute_schedule_wcc_try(node, graph, 1, max, &exhausted);
+		if (res || !exhausted)
+			goto done;
+	}
+
+	res = insert_identity_schedule(node, graph, &valid);
+	if (!res || valid)
+		goto done;
+
+	res = isl_schedule_node_free(res);
+	graph->root->budget = 1;
+	res = compute_schedule_wcc_algorithm(isl_schedule_node_copy(node),
+						graph);
+	graph->root->budget = 0;
+done:
+	isl_schedule_node_free(node);
+	return res;
+}
+
 /* Compute a schedule for each group of nodes identified by node->scc
  * separately and then combine them in a sequence node (or as set node
  * if graph->weak is set) inserted at position "node" of the schedule tree.
  * Return the updated schedule node.
  *
+ * The subgraphs of all groups are extracted in a single pass
+ * by isl_sched_graph_extract_components.
+ * The schedules of the groups are computed independently of each other
+ * and inserted in the order of the groups.  Each subgraph is freed
+ * as soon as its schedule has been computed.
+ *
  * If "wcc" is set then each of the groups belongs to a single
  * weakly connected component in the dependence graph so that
- * there is no need for compute_sub_schedule to look for weakly
- * connected components.
+ * there is no need to look for weakly connected components
+ * inside each group.
  *
  * If a set node would be introduced and if the number of components
  * is equal to the number of nodes, then check if the schedule
@@ -5804,6 +6238,7 @@ static __isl_give isl_schedule_node *compute_component_schedule(
 	int component;
 	isl_ctx *ctx;
 	isl_union_set_list *filters;
+	struct isl_sched_graph *split;
 
 	if (!node)
 		return NULL;
@@ -5816,6 +6251,12 @@ static __isl_give isl_schedule_node *compute_component_schedule(
 	}
 
 	ctx = isl_schedule_node_get_ctx(node);
+	split = isl_calloc_array(ctx, struct isl_sched_graph, graph->scc);
+	if (!split)
+		return isl_schedule_node_free(node);
+	if (isl_sched_graph_extract_components(ctx, graph, split) < 0)
+		node = isl_schedule_node_free(node);
+
 	filters = isl_sched_graph_extract_sccs(ctx, graph);
 	if (graph->weak)
 		node = isl_schedule_node_insert_set(node, filters);
@@ -5824,13 +6265,15 @@ static __isl_give isl_schedule_node *compute_component_schedule(
 
 	for (component = 0; component < graph->scc; ++component) {
 		node = isl_schedule_node_grandchild(node, component, 0);
-		node = compute_sub_schedule(node, ctx, graph,
-				    &isl_sched_node_scc_exactly,
-				    &isl_sched_edge_scc_exactly,
-				    component, wcc);
+		if (wcc)
+			node = compute_schedule_wcc(node, &split[component]);
+		else
+			node = compute_schedule(node, &split[component]);
 		node = isl_schedule_node_grandparent(node);
+		isl_sched_graph_free(ctx, &split[component]);
 	}
 
+	free(split);
 	return node;
 }
 
@@ -5900,6 +6343,8 @@ __isl_give isl_schedule *isl_schedule_constraints_compute_schedule(
 		isl_schedule_constraints_free(sc);
 		return isl_schedule_from_domain(domain);
 	}
+	isl_ctx_trace_begin(ctx,
+		"isl_schedule_constraints_compute_schedule", n);
 
 	if (n < 0 || isl_sched_graph_init(&graph, sc) < 0)
 		domain = isl_union_set_free(domain);
@@ -5913,6 +6358,7 @@ __isl_give isl_schedule *isl_schedule_constraints_compute_schedule(
 
 	isl_sched_graph_free(ctx, &graph);
 	isl_schedule_constraints_free(sc);
+	isl_ctx_trace_end(ctx, "isl_schedule_constraints_compute_schedule", n);
 
 	return sched;
 }
@@ -5936,3 +6382,483 @@ __isl_give isl_schedule *isl_union_set_compute_schedule(
 
 	return isl_schedule_constraints_compute_schedule(sc);
 }
+
+/* Internal data structure for isl_schedule_constraints_update_schedule.
+ *
+ * "n" is the number of statements in the domain of the schedule constraints.
+ * "space" contains the spaces of these statements.
+ * "parent" is used to keep track of the connected components
+ * of statements that are related by schedule constraints.
+ * "tagged" is set if the constraints that are currently being considered
+ * may be tagged.
+ *
+ * "validity" contains the untagged validity and
+ * conditional validity constraints.
+ * "coincidence" contains the untagged coincidence constraints.
+ */
+struct isl_update_schedule_data {
+	int n;
+	isl_space **space;
+	int *parent;
+	int tagged;
+
+	isl_union_map *validity;
+	isl_union_map *coincidence;
+};
+
+/* Free all memory allocated for "data".
+ */
+static void update_schedule_data_clear(struct isl_update_schedule_data *data)
+{
+	int i;
+
+	if (data->space)
+		for (i = 0; i < data->n; ++i)
+			isl_space_free(data->space[i]);
+	free(data->space);
+	free(data->parent);
+	isl_union_map_free(data->validity);
+	isl_union_map_free(data->coincidence);
+}
+
+/* Store the space of "set" in the next position of data->space.
+ */
+static isl_stat collect_statement_space(__isl_take isl_set *set, void *user)
+{
+	struct isl_update_schedule_data *data = user;
+
+	data->space[data->n] = isl_set_get_space(set);
+	data->parent[data->n] = data->n;
+	data->n++;
+	isl_set_free(set);
+
+	return data->space[data->n - 1] ? isl_stat_ok : isl_stat_error;
+}
+
+/* Return the position of the statement with space "space" in data->space,
+ * data->n if there is no such statement or -1 on error.
+ */
+static int find_statement(struct isl_update_schedule_data *data,
+	__isl_keep isl_space *space)
+{
+	int i;
+
+	for (i = 0; i < data->n; ++i) {
+		isl_bool equal;
+
+		equal = isl_space_tuple_is_equal(data->space[i], isl_dim_set,
+						space, isl_dim_set);
+		if (equal < 0)
+			return -1;
+		if (equal)
+			return i;
+	}
+
+	return data->n;
+}
+
+/* Return the representative of the component containing statement "i".
+ */
+static int find_component(struct isl_update_schedule_data *data, int i)
+{
+	while (data->parent[i] != i) {
+		data->parent[i] = data->parent[data->parent[i]];
+		i = data->parent[i];
+	}
+
+	return i;
+}
+
+/* Remove the tags from "map" if it is tagged.
+ * As in extract_edge, a map that may be tagged is considered
+ * to be tagged if it can be zipped.
+ */
+static __isl_give isl_map *untag(__isl_take isl_map *map, int tagged)
+{
+	if (tagged && isl_map_can_zip(map))
+		map = isl_set_unwrap(isl_map_domain(isl_map_zip(map)));
+	return map;
+}
+
+/* Merge the components containing the domain and
+ * the range statements of the schedule constraint "map".
+ * Constraints involving statements outside the domain
+ * of the schedule constraints are ignored.
+ */
+static isl_stat connect_statements(__isl_take isl_map *map, void *user)
+{
+	struct isl_update_schedule_data *data = user;
+	isl_space *space;
+	isl_space *dom, *ran;
+	int i, j;
+
+	map = untag(map, data->tagged);
+	space = isl_map_get_space(map);
+	isl_map_free(map);
+	dom = isl_space_domain(isl_space_copy(space));
+	ran = isl_space_range(space);
+	i = find_statement(data, dom);
+	j = find_statement(data, ran);
+	isl_space_free(dom);
+	isl_space_free(ran);
+	if (i < 0 || j < 0)
+		return isl_stat_error;
+	if (i >= data->n || j >= data->n)
+		return isl_stat_ok;
+
+	i = find_component(data, i);
+	j = find_component(data, j);
+	if (i < j)
+		data->parent[j] = i;
+	else
+		data->parent[i] = j;
+
+	return isl_stat_ok;
+}
+
+/* Add the untagged form of "map" to "umap".
+ */
+static isl_stat add_untagged(__isl_take isl_map *map, void *user)
+{
+	isl_union_map **umap = user;
+
+	*umap = isl_union_map_add_map(*umap, untag(map, 1));
+
+	return *umap ? isl_stat_ok : isl_stat_error;
+}
+
+/* Return the untagged form of the schedule constraints
+ * of type "type" in "sc".
+ */
+static __isl_give isl_union_map *get_untagged(
+	__isl_keep isl_schedule_constraints *sc, enum isl_edge_type type)
+{
+	isl_union_map *c, *res;
+	isl_space *space;
+
+	c = isl_schedule_constraints_get(sc, type);
+	space = isl_union_map_get_space(c);
+	res = isl_union_map_empty(space);
+	if (isl_union_map_foreach_map(c, &add_untagged, &res) < 0)
+		res = isl_union_map_free(res);
+	isl_union_map_free(c);
+
+	return res;
+}
+
+/* Initialize "data" from "sc".
+ * In particular, collect the statements in the domain of "sc" and
+ * group them into components of statements that are (indirectly)
+ * related by schedule constraints of any type.
+ */
+static isl_stat update_schedule_data_init(
+	struct isl_update_schedule_data *data,
+	__isl_keep isl_schedule_constraints *sc)
+{
+	isl_ctx *ctx;
+	isl_union_set *domain;
+	isl_union_map *c;
+	isl_size n;
+	enum isl_edge_type i;
+
+	ctx = isl_schedule_constraints_get_ctx(sc);
+	domain = isl_schedule_constraints_get_domain(sc);
+	n = isl_union_set_n_set(domain);
+	if (n < 0) {
+		isl_union_set_free(domain);
+		return isl_stat_error;
+	}
+	data->space = isl_calloc_array(ctx, isl_space *, n);
+	data->parent = isl_alloc_array(ctx, int, n);
+	if ((n && (!data->space || !data->parent)) ||
+	    isl_union_set_foreach_set(domain, &collect_statement_space,
+					data) < 0) {
+		isl_union_set_free(domain);
+		return isl_stat_error;
+	}
+	isl_union_set_free(domain);
+
+	for (i = isl_edge_first; i <= isl_edge_last; ++i) {
+		isl_stat r;
+
+		data->tagged = i == isl_edge_condition ||
+				i == isl_edge_conditional_validity;
+		c = isl_schedule_constraints_get(sc, i);
+		r = isl_union_map_foreach_map(c, &connect_statements, data);
+		isl_union_map_free(c);
+		if (r < 0)
+			return isl_stat_error;
+	}
+
+	data->validity = isl_schedule_constraints_get(sc, isl_edge_validity);
+	data->validity = isl_union_map_union(data->validity,
+			get_untagged(sc, isl_edge_conditional_validity));
+	data->coincidence = isl_schedule_constraints_get(sc,
+							isl_edge_coincidence);
+	if (!data->validity || !data->coincidence)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Return the union of the statement domains in "sc"
+ * that belong to the component with representative "c".
+ */
+static __isl_give isl_union_set *extract_component(
+	struct isl_update_schedule_data *data,
+	__isl_keep isl_schedule_constraints *sc, int c)
+{
+	int i;
+	isl_union_set *domain, *res;
+
+	domain = isl_schedule_constraints_get_domain(sc);
+	res = isl_union_set_empty(isl_union_set_get_space(domain));
+	for (i = 0; i < data->n; ++i) {
+		isl_set *set;
+
+		if (find_component(data, i) != c)
+			continue;
+		set = isl_union_set_extract_set(domain,
+					isl_space_copy(data->space[i]));
+		res = isl_union_set_add_set(res, set);
+	}
+	isl_union_set_free(domain);
+
+	return res;
+}
+
+/* Can the schedule "schedule" be reused for the statements in "domain"?
+ * That is, does it cover all elements of "domain" (within "context")
+ * and does it respect all validity and conditional validity constraints
+ * in data->validity that start in "domain"?
+ * The constraints are respected if the schedule maps the source
+ * of each dependence strictly lexicographically before its sink.
+ * Note that conditional validity constraints are therefore treated
+ * as plain validity constraints, even though the scheduler may
+ * violate them locally.
+ */
+static isl_bool can_reuse(struct isl_update_schedule_data *data,
+	__isl_keep isl_schedule *schedule, __isl_keep isl_union_set *domain,
+	__isl_keep isl_set *context)
+{
+	isl_union_map *map, *lt, *dep;
+	isl_union_set *dom, *covered;
+	isl_bool ok;
+
+	map = isl_schedule_get_map(schedule);
+	map = isl_union_map_intersect_domain(map, isl_union_set_copy(domain));
+	dom = isl_union_set_copy(domain);
+	dom = isl_union_set_intersect_params(dom, isl_set_copy(context));
+	covered = isl_union_map_domain(isl_union_map_copy(map));
+	ok = isl_union_set_is_subset(dom, covered);
+	isl_union_set_free(dom);
+	isl_union_set_free(covered);
+	if (ok < 0 || !ok) {
+		isl_union_map_free(map);
+		return ok;
+	}
+
+	lt = isl_union_map_lex_lt_union_map(isl_union_map_copy(map), map);
+	dep = isl_union_map_copy(data->validity);
+	dep = isl_union_map_intersect_domain(dep, isl_union_set_copy(domain));
+	dep = isl_union_map_intersect_params(dep, isl_set_copy(context));
+	ok = isl_union_map_is_subset(dep, lt);
+	isl_union_map_free(dep);
+	isl_union_map_free(lt);
+
+	return ok;
+}
+
+/* Mark member "pos" of the band node "node" as not being coincident.
+ */
+static __isl_give isl_schedule_node *reset_coincident(
+	__isl_take isl_schedule_node *node, int pos)
+{
+	return isl_schedule_node_band_member_set_coincident(node, pos, 0);
+}
+
+/* If "node" is a band node, then check whether its permutable and
+ * coincident properties still hold with respect to the constraints
+ * in "data" and reset them if they do not.
+ * The band is permutable if all validity dependence distances
+ * are non-negative in each member, while a member is coincident
+ * if all coincidence dependence distances are zero in that member,
+ * in both cases only considering the dependences between
+ * instances with the same prefix schedule.
+ */
+static __isl_give isl_schedule_node *update_band_properties(
+	__isl_take isl_schedule_node *node, void *user)
+{
+	struct isl_update_schedule_data *data = user;
+	isl_union_map *prefix, *same;
+	isl_union_map *validity, *coincidence;
+	isl_multi_union_pw_aff *mupa;
+	isl_bool permutable;
+	isl_size n;
+	int i;
+
+	if (isl_schedule_node_get_type(node) != isl_schedule_node_band)
+		return node;
+
+	n = isl_schedule_node_band_n_member(node);
+	permutable = isl_schedule_node_band_get_permutable(node);
+	if (n < 0 || permutable < 0)
+		return isl_schedule_node_free(node);
+
+	prefix = isl_schedule_node_get_prefix_schedule_union_map(node);
+	same = isl_union_map_apply_range(isl_union_map_copy(prefix),
+					isl_union_map_reverse(prefix));
+	validity = isl_union_map_intersect(isl_union_map_copy(data->validity),
+					isl_union_map_copy(same));
+	coincidence = isl_union_map_intersect(
+			isl_union_map_copy(data->coincidence), same);
+	mupa = isl_schedule_node_band_get_partial_schedule(node);
+
+	for (i = 0; node && i < n; ++i) {
+		isl_union_pw_aff *upa;
+		isl_union_map *umap, *cmp;
+		isl_bool coincident, ok;
+
+		coincident = isl_schedule_node_band_member_get_coincident(node,
+									i);
+		if (coincident < 0) {
+			node = isl_schedule_node_free(node);
+			break;
+		}
+		if (!permutable && !coincident)
+			continue;
+		upa = isl_multi_union_pw_aff_get_union_pw_aff(mupa, i);
+		umap = isl_union_map_from_union_pw_aff(upa);
+		if (permutable) {
+			cmp = isl_union_map_lex_le_union_map(
+				isl_union_map_copy(umap),
+				isl_union_map_copy(umap));
+			ok = isl_union_map_is_subset(validity, cmp);
+			isl_union_map_free(cmp);
+			if (ok < 0)
+				node = isl_schedule_node_free(node);
+			else if (!ok) {
+				node = isl_schedule_node_band_set_permutable(
+								node, 0);
+				permutable = isl_bool_false;
+			}
+		}
+		if (coincident) {
+			cmp = isl_union_map_apply_range(
+				isl_union_map_copy(umap),
+				isl_union_map_reverse(isl_union_map_copy(umap)));
+			ok = isl_union_map_is_subset(coincidence, cmp);
+			isl_union_map_free(cmp);
+			if (ok < 0)
+				node = isl_schedule_node_free(node);
+			else if (!ok)
+				node = reset_coincident(node, i);
+		}
+		isl_union_map_free(umap);
+	}
+
+	isl_multi_union_pw_aff_free(mupa);
+	isl_union_map_free(validity);
+	isl_union_map_free(coincidence);
+
+	return node;
+}
+
+/* Compute a schedule for the statements in "domain" that belong
+ * to a single component of the schedule constraints "sc",
+ * reusing "schedule" if possible.
+ * If "schedule" can be reused, then it is restricted to "domain" and
+ * the properties of its band nodes are updated to reflect
+ * the current schedule constraints.
+ * Otherwise, a schedule is computed from scratch for
+ * the schedule constraints restricted to "domain".
+ */
+static __isl_give isl_schedule *update_component_schedule(
+	struct isl_update_schedule_data *data,
+	__isl_keep isl_schedule_constraints *sc,
+	__isl_keep isl_schedule *schedule, __isl_take isl_union_set *domain)
+{
+	isl_set *context;
+	isl_bool reuse;
+
+	context = isl_schedule_constraints_get_context(sc);
+	reuse = can_reuse(data, schedule, domain, context);
+	isl_set_free(context);
+	if (reuse < 0) {
+		isl_union_set_free(domain);
+		return NULL;
+	}
+	if (reuse) {
+		isl_schedule *res;
+
+		res = isl_schedule_copy(schedule);
+		res = isl_schedule_intersect_domain(res, domain);
+		return isl_schedule_map_schedule_node_bottom_up(res,
+					&update_band_properties, data);
+	}
+
+	sc = isl_schedule_constraints_copy(sc);
+	sc = isl_schedule_constraints_apply(sc, isl_union_set_identity(domain));
+	return isl_schedule_constraints_compute_schedule(sc);
+}
+
+/* Compute a schedule for the schedule constraints "sc",
+ * reusing the parts of a previously computed "schedule"
+ * that are still valid.
+ * "schedule" is typically the result of an earlier call to
+ * isl_schedule_constraints_compute_schedule on schedule constraints
+ * that only differ slightly from "sc".
+ *
+ * The statements are first grouped into components of statements
+ * that are (indirectly) related by schedule constraints.
+ * Different components do not constrain each other and
+ * can therefore be scheduled independently.
+ * For each component, if "schedule" covers all its statement instances and
+ * respects all its validity constraints, then it is restricted
+ * to the component.  Otherwise, a schedule is computed from scratch
+ * for the component.
+ * The resulting schedules are combined in a set node.
+ */
+__isl_give isl_schedule *isl_schedule_constraints_update_schedule(
+	__isl_take isl_schedule_constraints *sc,
+	__isl_take isl_schedule *schedule)
+{
+	struct isl_update_schedule_data data = { 0 };
+	isl_schedule *res = NULL;
+	int i;
+
+	sc = isl_schedule_constraints_align_params(sc);
+	if (!sc || !schedule)
+		goto done;
+
+	if (update_schedule_data_init(&data, sc) < 0)
+		goto done;
+	if (data.n == 0) {
+		res = isl_schedule_from_domain(
+				isl_schedule_constraints_get_domain(sc));
+		goto done;
+	}
+
+	for (i = 0; i < data.n; ++i) {
+		isl_union_set *domain;
+		isl_schedule *sched_i;
+
+		if (find_component(&data, i) != i)
+			continue;
+		domain = extract_component(&data, sc, i);
+		sched_i = update_component_schedule(&data, sc, schedule,
+						    domain);
+		if (!res)
+			res = sched_i;
+		else
+			res = isl_schedule_set(res, sched_i);
+		if (!res)
+			goto done;
+	}
+
+done:
+	update_schedule_data_clear(&data);
+	isl_schedule_constraints_free(sc);
+	isl_schedule_free(schedule);
+	return res;
+}
@@ -175,6 +175,8 @@ int isl_sched_edge_is_proximity(struct isl_sched_edge *edge);
  * if compression is involved then the key for these maps
  * is the original, uncompressed dependence relation, while
  * the value is the dual of the compressed dependence relation.
+ * These caches are only allocated in the root graph and are shared
+ * by all its subgraphs.
  *
  * n is the number of nodes
  * node is the list of nodes
@@ -217,6 +219,12 @@ int isl_sched_edge_is_proximity(struct isl_sched_edge *edge);
  *
  * max_weight is used during clustering and represents the maximal
  * weight of the relevant proximity edges.
+ *
+ * budget is set if a schedule is being computed under the operation
+ *	budget imposed by the schedule_max_operations option
+ * feautrier is set if Feautrier's algorithm should be used
+ *	irrespective of the schedule_algorithm option
+ * budget and feautrier are only used in the root graph.
  */
 struct isl_sched_graph {
 	isl_map_to_basic_set *intra_hmap;
@@ -253,6 +261,9 @@ struct isl_sched_graph {
 	int weak;
 
 	int max_weight;
+
+	int budget;
+	int feautrier;
 };
 
 isl_stat isl_sched_graph_init(struct isl_sched_graph *graph,
@@ -279,6 +290,8 @@ isl_stat isl_sched_graph_extract_sub_graph(isl_ctx *ctx,
 	int (*node_pred)(struct isl_sched_node *node, int data),
 	int (*edge_pred)(struct isl_sched_edge *edge, int data),
 	int data, struct isl_sched_graph *sub);
+isl_stat isl_sched_graph_extract_components(isl_ctx *ctx,
+	struct isl_sched_graph *graph, struct isl_sched_graph *sub);
 isl_stat isl_sched_graph_compute_maxvar(struct isl_sched_graph *graph);
 isl_stat isl_schedule_node_compute_wcc_band(isl_ctx *ctx,
 	struct isl_sched_graph *graph);
@@ -21,7 +21,7 @@
 /* Initialize the clustering data structure "c" from "graph".
  *
  * In particular, allocate memory, extract the SCCs from "graph"
- * into c->scc, initialize scc_cluster and construct
+ * into c->scc (in a single pass), initialize scc_cluster and construct
  * a band of schedule rows for each SCC.
  * Within each SCC, there is only one SCC by definition.
  * Each SCC initially belongs to a cluster containing only that SCC.
@@ -41,12 +41,9 @@ static isl_stat clustering_init(isl_ctx *ctx, struct isl_clustering *c,
 	    !c->scc_cluster || !c->scc_node || !c->scc_in_merge)
 		return isl_stat_error;
 
+	if (isl_sched_graph_extract_components(ctx, graph, c->scc) < 0)
+		return isl_stat_error;
 	for (i = 0; i < c->n; ++i) {
-		if (isl_sched_graph_extract_sub_graph(ctx, graph,
-					&isl_sched_node_scc_exactly,
-					&isl_sched_edge_scc_exactly,
-					i, &c->scc[i]) < 0)
-			return isl_stat_error;
 		c->scc[i].scc = 1;
 		if (isl_sched_graph_compute_maxvar(&c->scc[i]) < 0)
 			return isl_stat_error;
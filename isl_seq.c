@@ -39,9 +39,20 @@ void isl_seq_neg(isl_int *dst, isl_int *src, unsigned len)
 		isl_int_neg(dst[i], src[i]);
 }
 
+#ifdef USE_SMALL_INT_OPT
+static int all_small(isl_int *p, unsigned len);
+static void cpy_small(isl_int *dst, isl_int *src, unsigned len);
+#endif
+
 void isl_seq_cpy(isl_int *dst, isl_int *src, unsigned len)
 {
 	int i;
+#ifdef USE_SMALL_INT_OPT
+	if (all_small(src, len) && all_small(dst, len)) {
+		cpy_small(dst, src, len);
+		return;
+	}
+#endif
 	for (i = 0; i < len; ++i)
 		isl_int_set(dst[i], src[i]);
 }
@@ -78,6 +89,81 @@ void isl_seq_swp_or_cpy(isl_int *dst, isl_int *src, unsigned len)
 		isl_int_swap_or_set(dst[i], src[i]);
 }
 
+#ifdef USE_SMALL_INT_OPT
+/* Return the bitwise conjunction of the representations of
+ * the "len" elements of "p".
+ * The result is in small representation if and only if
+ * all elements of "p" are in small representation.
+ * The loop does not contain any branches such that
+ * the compiler can vectorize it.
+ */
+static isl_sioimath small_tags(isl_int *p, unsigned len)
+{
+	int i;
+	isl_sioimath tags = ~(isl_sioimath) 0;
+
+	for (i = 0; i < len; ++i)
+		tags &= p[i][0];
+	return tags;
+}
+
+/* Are all "len" elements of "p" in small representation?
+ */
+static int all_small(isl_int *p, unsigned len)
+{
+	return isl_sioimath_is_small(small_tags(p, len));
+}
+
+/* Set "gcd" to the greatest common divisor of the "len" elements of "p",
+ * which are all known to be in small representation.
+ * Since the absolute values of these elements are all
+ * in the small range, so is their greatest common divisor.
+ */
+static void gcd_small(isl_int *p, unsigned len, isl_int *gcd)
+{
+	int i;
+	isl_sioimath_usmall g = 0;
+
+	for (i = 0; g != 1 && i < len; ++i) {
+		isl_sioimath_small v = isl_sioimath_get_small(p[i][0]);
+
+		if (v == 0)
+			continue;
+		g = isl_sioimath_smallgcd(g, v);
+	}
+	isl_sioimath_set_small(*gcd, g);
+}
+
+/* Copy the "len" elements of "src" to "dst", where all elements
+ * of "src" and "dst" are known to be in small representation.
+ * Since "dst" does not contain any elements in big representation,
+ * the representations can simply be copied.
+ */
+static void cpy_small(isl_int *dst, isl_int *src, unsigned len)
+{
+	int i;
+
+	for (i = 0; i < len; ++i)
+		dst[i][0] = src[i][0];
+}
+
+/* Set "dst" to "src" divided by "m", where all elements of "src" and "dst"
+ * are known to be in small representation and where "m" is known
+ * to exactly divide each element of "src".
+ * Since "dst" does not contain any elements in big representation,
+ * the results can be stored directly.
+ */
+static void scale_down_small(isl_int *dst, isl_int *src,
+	isl_sioimath_small m, unsigned len)
+{
+	int i;
+
+	for (i = 0; i < len; ++i)
+		dst[i][0] = isl_sioimath_encode_small(
+				isl_sioimath_get_small(src[i][0]) / m);
+}
+#endif
+
 void isl_seq_scale(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 {
 	int i;
@@ -88,6 +174,16 @@ void isl_seq_scale(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 void isl_seq_scale_down(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 {
 	int i;
+#ifdef USE_SMALL_INT_OPT
+	isl_sioimath_small small;
+
+	if (isl_sioimath_decode_small(m[0], &small) &&
+	    all_small(src, len) && (dst == src || all_small(dst, len))) {
+		scale_down_small(dst, src, small, len);
+		return;
+	}
+#endif
+
 	for (i = 0; i < len; ++i)
 		isl_int_divexact(dst[i], src[i], m);
 }
@@ -113,11 +209,70 @@ void isl_seq_fdiv_r(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 		isl_int_fdiv_r(dst[i], src[i], m);
 }
 
+#ifdef USE_SMALL_INT_OPT
+/* Compute m1 a + m2 b in "res" for numbers in small representation and
+ * return whether this computation does not overflow an int64_t.
+ * With the 32 bit small representation, it never overflows.
+ */
+static int small_combine(isl_sioimath_small m1, isl_sioimath_small a,
+	isl_sioimath_small m2, isl_sioimath_small b, int64_t *res)
+{
+#ifdef ISL_SIOIMATH_SMALL_64
+	int64_t p1, p2;
+
+	if (isl_sioimath_mul_overflow(m1, a, &p1) ||
+	    isl_sioimath_mul_overflow(m2, b, &p2))
+		return 0;
+	if (p2 > 0 ? p1 > INT64_MAX - p2 : p1 < -INT64_MAX - p2)
+		return 0;
+	*res = p1 + p2;
+#else
+	*res = (int64_t) m1 * a + (int64_t) m2 * b;
+#endif
+	return 1;
+}
+
+/* Set "dst" to m1 src1 + m2 src2, where "m1" and "m2" are known
+ * to be in small representation, with values "small1" and "small2".
+ * Elements of "src1" and "src2" that are both in small representation
+ * are combined directly in machine integers.
+ * The others, and those for which the result overflows, are combined
+ * using the generic operations.
+ */
+static void combine_small(isl_int *dst, isl_int m1, isl_sioimath_small small1,
+	isl_int *src1, isl_int m2, isl_sioimath_small small2, isl_int *src2,
+	unsigned len)
+{
+	int i;
+	isl_int tmp;
+
+	isl_int_init(tmp);
+	for (i = 0; i < len; ++i) {
+		isl_sioimath_small a, b;
+		int64_t res;
+
+		if (isl_sioimath_decode_small(src1[i][0], &a) &&
+		    isl_sioimath_decode_small(src2[i][0], &b) &&
+		    small_combine(small1, a, small2, b, &res)) {
+			isl_sioimath_set_int64(dst[i], res);
+			continue;
+		}
+		isl_int_mul(tmp, m1, src1[i]);
+		isl_int_addmul(tmp, m2, src2[i]);
+		isl_int_set(dst[i], tmp);
+	}
+	isl_int_clear(tmp);
+}
+#endif
+
 void isl_seq_combine(isl_int *dst, isl_int m1, isl_int *src1,
 			isl_int m2, isl_int *src2, unsigned len)
 {
 	int i;
 	isl_int tmp;
+#ifdef USE_SMALL_INT_OPT
+	isl_sioimath_small small1, small2;
+#endif
 
 	if (dst == src1 && isl_int_is_one(m1)) {
 		if (isl_int_is_zero(m2))
@@ -127,6 +282,14 @@ void isl_seq_combine(isl_int *dst, isl_int m1, isl_int *src1,
 		return;
 	}
 
+#ifdef USE_SMALL_INT_OPT
+	if (isl_sioimath_decode_small(m1[0], &small1) &&
+	    isl_sioimath_decode_small(m2[0], &small2)) {
+		combine_small(dst, m1, small1, src1, m2, small2, src2, len);
+		return;
+	}
+#endif
+
 	isl_int_init(tmp);
 	for (i = 0; i < len; ++i) {
 		isl_int_mul(tmp, m1, src1[i]);
@@ -170,12 +333,29 @@ void isl_seq_elim(isl_int *dst, isl_int *src, unsigned pos, unsigned len,
 	isl_int_clear(b);
 }
 
+/* Are the "len" elements of "p1" and "p2" equal?
+ *
+ * Since the small representation of a number is unique,
+ * two numbers in small representation are equal
+ * if and only if their representations are equal.
+ * The elements are checked one by one such that
+ * the loop can exit as soon as a difference is found.
+ */
 int isl_seq_eq(isl_int *p1, isl_int *p2, unsigned len)
 {
 	int i;
-	for (i = 0; i < len; ++i)
+
+	for (i = 0; i < len; ++i) {
+#ifdef USE_SMALL_INT_OPT
+		if (isl_sioimath_is_small(p1[i][0] & p2[i][0])) {
+			if (p1[i][0] != p2[i][0])
+				return 0;
+			continue;
+		}
+#endif
 		if (isl_int_ne(p1[i], p2[i]))
 			return 0;
+	}
 	return 1;
 }
 
@@ -204,13 +384,30 @@ int isl_seq_is_neg(isl_int *p1, isl_int *p2, unsigned len)
 	return 1;
 }
 
+/* Return the position of the first non-zero element among
+ * the "len" elements of "p", or -1 if there is no such element.
+ *
+ * An element in small representation is zero if and only if
+ * its representation is that of zero.
+ */
 int isl_seq_first_non_zero(isl_int *p, unsigned len)
 {
 	int i;
+#ifdef USE_SMALL_INT_OPT
+	isl_sioimath zero = isl_sioimath_encode_small(0);
+#endif
 
-	for (i = 0; i < len; ++i)
+	for (i = 0; i < len; ++i) {
+#ifdef USE_SMALL_INT_OPT
+		if (isl_sioimath_is_small(p[i][0])) {
+			if (p[i][0] != zero)
+				return i;
+			continue;
+		}
+#endif
 		if (!isl_int_is_zero(p[i]))
 			return i;
+	}
 	return -1;
 }
 
@@ -259,7 +456,16 @@ int isl_seq_abs_min_non_zero(isl_int *p, unsigned len)
 
 void isl_seq_gcd(isl_int *p, unsigned len, isl_int *gcd)
 {
-	int i, min = isl_seq_abs_min_non_zero(p, len);
+	int i, min;
+
+#ifdef USE_SMALL_INT_OPT
+	if (all_small(p, len)) {
+		gcd_small(p, len, gcd);
+		return;
+	}
+#endif
+
+	min = isl_seq_abs_min_non_zero(p, len);
 
 	if (min < 0) {
 		isl_int_set_si(*gcd, 0);
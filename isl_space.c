@@ -16,8 +16,10 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <isl_ctx_private.h>
 #include <isl_space_private.h>
 #include <isl_id_private.h>
+#include <isl_options_private.h>
 #include <isl_reordering.h>
 
 isl_ctx *isl_space_get_ctx(__isl_keep isl_space *space)
@@ -37,6 +39,7 @@ __isl_give isl_space *isl_space_alloc(isl_ctx *ctx,
 	space->ctx = ctx;
 	isl_ctx_ref(ctx);
 	space->ref = 1;
+	space->interned = 0;
 	space->nparam = nparam;
 	space->n_in = n_in;
 	space->n_out = n_out;
@@ -455,13 +458,107 @@ error:
 	return NULL;
 }
 
+/* Is "entry" the space "val"?
+ */
+static isl_bool is_space(const void *entry, const void *val)
+{
+	return isl_bool_ok(entry == val);
+}
+
+/* Remove "space" from the table of interned spaces of its context.
+ */
+static void unintern(__isl_keep isl_space *space)
+{
+	struct isl_hash_table_entry *entry;
+	isl_ctx *ctx = space->ctx;
+
+	space->interned = 0;
+	entry = isl_hash_table_find(ctx, ctx->space_table,
+				isl_space_get_full_hash(space),
+				&is_space, space, 0);
+	if (entry && entry != isl_hash_table_entry_none)
+		isl_hash_table_remove(ctx, ctx->space_table, entry);
+}
+
+/* Is the space "entry" identical to the space "val",
+ * including the identifiers of all dimensions?
+ */
+static isl_bool is_identical_space(const void *entry, const void *val)
+{
+	isl_space *space1 = (isl_space *) entry;
+	isl_space *space2 = (isl_space *) val;
+	isl_bool equal;
+
+	equal = isl_space_is_equal(space1, space2);
+	if (equal < 0 || !equal)
+		return equal;
+	return isl_space_has_equal_ids(space1, space2);
+}
+
+/* Return the canonical copy of "space" if the spaces
+ * in the context of "space" are being interned.
+ *
+ * That is, if an identical space has already been interned,
+ * then return (a copy of) that space.  Otherwise, add "space" itself
+ * to the table of interned spaces.
+ * This allows identical spaces to be represented by the same object,
+ * such that they can be compared by simply comparing pointers.
+ * The table does not hold a reference to the spaces it contains.
+ * Instead, a space is removed from the table when it is freed
+ * or when it is about to be modified in-place by isl_space_cow.
+ *
+ * A frozen context is never modified, so no spaces are interned
+ * in such a context.
+ */
+__isl_give isl_space *isl_space_intern(__isl_take isl_space *space)
+{
+	isl_ctx *ctx;
+	struct isl_hash_table_entry *entry;
+
+	if (!space)
+		return NULL;
+	if (space->interned)
+		return space;
+	ctx = space->ctx;
+	if (!ctx->opt->intern_spaces || ctx->frozen)
+		return space;
+
+	if (!ctx->space_table) {
+		ctx->space_table = isl_hash_table_alloc(ctx, 0);
+		if (!ctx->space_table)
+			return isl_space_free(space);
+	}
+	entry = isl_hash_table_find(ctx, ctx->space_table,
+				isl_space_get_full_hash(space),
+				&is_identical_space, space, 1);
+	if (!entry)
+		return isl_space_free(space);
+	if (entry->data) {
+		isl_space_free(space);
+		return isl_space_copy(entry->data);
+	}
+	entry->data = space;
+	space->interned = 1;
+	ctx->stats->space_interned++;
+	return space;
+}
+
+/* Return a copy of "space" that can be modified in-place.
+ *
+ * If "space" has a single reference but appears in the table
+ * of interned spaces, then it is removed from this table
+ * since it is about to be modified.
+ */
 __isl_give isl_space *isl_space_cow(__isl_take isl_space *space)
 {
 	if (!space)
 		return NULL;
 
-	if (space->ref == 1)
+	if (space->ref == 1) {
+		if (space->interned)
+			unintern(space);
 		return space;
+	}
 	space->ref--;
 	return isl_space_dup(space);
 }
@@ -485,6 +582,9 @@ __isl_null isl_space *isl_space_free(__isl_take isl_space *space)
 	if (--space->ref > 0)
 		return NULL;
 
+	if (space->interned)
+		unintern(space);
+
 	isl_id_free(space->tuple_id[0]);
 	isl_id_free(space->tuple_id[1]);
 
@@ -2766,7 +2866,8 @@ static uint32_t isl_hash_params(uint32_t hash, __isl_keep isl_space *space)
 }
 
 /* Update "hash" by hashing in the tuples of "space".
- * Changes in this function should be reflected in isl_hash_tuples_domain.
+ * Changes in this function should be reflected in isl_hash_tuples_domain
+ * and isl_hash_tuples_range.
  */
 static uint32_t isl_hash_tuples(uint32_t hash, __isl_keep isl_space *space)
 {
@@ -2813,10 +2914,35 @@ static uint32_t isl_hash_tuples_domain(uint32_t hash,
 	return hash;
 }
 
+/* Update "hash" by hashing in the range tuple of "space".
+ * The result of this function is equal to the result of applying
+ * isl_hash_tuples to the range of "space".
+ */
+static uint32_t isl_hash_tuples_range(uint32_t hash,
+	__isl_keep isl_space *space)
+{
+	isl_id *id;
+
+	if (!space)
+		return hash;
+
+	isl_hash_byte(hash, 0);
+	isl_hash_byte(hash, space->n_out % 256);
+
+	hash = isl_hash_id(hash, &isl_id_none);
+	id = tuple_id(space, isl_dim_out);
+	hash = isl_hash_id(hash, id);
+
+	hash = isl_hash_tuples(hash, space->nested[1]);
+
+	return hash;
+}
+
 /* Return a hash value that digests the tuples of "space",
  * i.e., that ignores the parameters.
  * Changes in this function should be reflected
- * in isl_space_get_tuple_domain_hash.
+ * in isl_space_get_tuple_domain_hash and
+ * isl_space_get_tuple_range_hash.
  */
 uint32_t isl_space_get_tuple_hash(__isl_keep isl_space *space)
 {
@@ -2864,6 +2990,23 @@ uint32_t isl_space_get_tuple_domain_hash(__isl_keep isl_space *space)
 	return hash;
 }
 
+/* Return the hash value of the range tuple of "space".
+ * That is, isl_space_get_tuple_range_hash(space) is equal to
+ * isl_space_get_tuple_hash(isl_space_range(space)).
+ */
+uint32_t isl_space_get_tuple_range_hash(__isl_keep isl_space *space)
+{
+	uint32_t hash;
+
+	if (!space)
+		return 0;
+
+	hash = isl_hash_init();
+	hash = isl_hash_tuples_range(hash, space);
+
+	return hash;
+}
+
 /* Is "space" the space of a set wrapping a map space?
  */
 isl_bool isl_space_is_wrapping(__isl_keep isl_space *space)
@@ -7,8 +7,12 @@
 #include <isl/stream.h>
 
 struct isl_name;
+/* If "interned" is set, then the space appears in the table
+ * of interned spaces of its context (see isl_space_intern).
+ */
 struct isl_space {
 	int ref;
+	int interned;
 
 	struct isl_ctx *ctx;
 
@@ -24,12 +28,14 @@ struct isl_space {
 };
 
 __isl_give isl_space *isl_space_cow(__isl_take isl_space *space);
+__isl_give isl_space *isl_space_intern(__isl_take isl_space *space);
 
 __isl_give isl_space *isl_space_underlying(__isl_take isl_space *space,
 	unsigned n_div);
 
 uint32_t isl_space_get_tuple_hash(__isl_keep isl_space *space);
 uint32_t isl_space_get_tuple_domain_hash(__isl_keep isl_space *space);
+uint32_t isl_space_get_tuple_range_hash(__isl_keep isl_space *space);
 uint32_t isl_space_get_full_hash(__isl_keep isl_space *space);
 
 isl_bool isl_space_has_domain_tuples(__isl_keep isl_space *space1,
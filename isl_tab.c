@@ -13,6 +13,7 @@
  * B.P. 105 - 78153 Le Chesnay, France
  */
 
+#include <math.h>
 #include <isl_ctx_private.h>
 #include <isl_mat_private.h>
 #include <isl_vec_private.h>
@@ -20,6 +21,7 @@
 #include "isl_tab.h"
 #include <isl_seq.h>
 #include <isl_config.h>
+#include <isl_options_private.h>
 
 #include <bset_to_bmap.c>
 #include <bset_from_bmap.c>
@@ -40,6 +42,7 @@ struct isl_tab *isl_tab_alloc(struct isl_ctx *ctx,
 	tab = isl_calloc_type(ctx, struct isl_tab);
 	if (!tab)
 		return NULL;
+	ctx->stats->tab_alloc++;
 	tab->mat = isl_mat_alloc(ctx, n_row, off + n_var);
 	if (!tab->mat)
 		goto error;
@@ -102,6 +105,21 @@ isl_ctx *isl_tab_get_ctx(struct isl_tab *tab)
 	return tab ? isl_mat_get_ctx(tab->mat) : NULL;
 }
 
+/* Return the size to which an array of size "size" should be extended
+ * to hold at least "min" elements.
+ * The size is increased by at least half of the current size
+ * such that repeatedly adding a few elements only requires
+ * a logarithmic number of reallocations.
+ */
+static unsigned grow_size(unsigned size, unsigned min)
+{
+	size += size / 2;
+	return size < min ? min : size;
+}
+
+/* Make room for at least n_new extra constraints.
+ * Return -1 if anything went wrong.
+ */
 int isl_tab_extend_cons(struct isl_tab *tab, unsigned n_new)
 {
 	unsigned off;
@@ -113,19 +131,22 @@ int isl_tab_extend_cons(struct isl_tab *tab, unsigned n_new)
 
 	if (tab->max_con < tab->n_con + n_new) {
 		struct isl_tab_var *con;
+		unsigned max_con;
 
+		max_con = grow_size(tab->max_con, tab->n_con + n_new);
 		con = isl_realloc_array(tab->mat->ctx, tab->con,
-				    struct isl_tab_var, tab->max_con + n_new);
+				    struct isl_tab_var, max_con);
 		if (!con)
 			return -1;
 		tab->con = con;
-		tab->max_con += n_new;
+		tab->max_con = max_con;
 	}
 	if (tab->mat->n_row < tab->n_row + n_new) {
 		int *row_var;
 
 		tab->mat = isl_mat_extend(tab->mat,
-					tab->n_row + n_new, off + tab->n_col);
+			    grow_size(tab->mat->n_row, tab->n_row + n_new),
+			    off + tab->n_col);
 		if (!tab->mat)
 			return -1;
 		row_var = isl_realloc_array(tab->mat->ctx, tab->row_var,
@@ -220,6 +241,29 @@ void isl_tab_free(struct isl_tab *tab)
 	free(tab);
 }
 
+/* Return a copy of the matrix of "tab" of the same size,
+ * but only copy the part that is currently in use,
+ * i.e., the first tab->n_row rows and the first 2 + M + tab->n_col
+ * columns.  The remaining entries are reserved for rows and columns
+ * that may get added later and they are never read before
+ * they are explicitly set.
+ */
+static __isl_give isl_mat *dup_mat(struct isl_tab *tab)
+{
+	int i;
+	isl_mat *mat;
+	unsigned n_col = 2 + tab->M + tab->n_col;
+
+	mat = isl_mat_alloc(isl_tab_get_ctx(tab),
+				tab->mat->n_row, tab->mat->n_col);
+	if (!mat)
+		return NULL;
+	for (i = 0; i < tab->n_row; ++i)
+		isl_seq_cpy(mat->row[i], tab->mat->row[i], n_col);
+
+	return mat;
+}
+
 struct isl_tab *isl_tab_dup(struct isl_tab *tab)
 {
 	int i;
@@ -233,7 +277,7 @@ struct isl_tab *isl_tab_dup(struct isl_tab *tab)
 	dup = isl_calloc_type(tab->mat->ctx, struct isl_tab);
 	if (!dup)
 		return NULL;
-	dup->mat = isl_mat_dup(tab->mat);
+	dup->mat = dup_mat(tab);
 	if (!dup->mat)
 		goto error;
 	dup->var = isl_alloc_array(tab->mat->ctx, struct isl_tab_var, tab->max_var);
@@ -1131,12 +1175,18 @@ static void update_row_sign(struct isl_tab *tab, int row, int col, int row_sgn)
  * s(n_rc)d_r/|n_rc|		-s(n_rc)n_ri/|n_rc|
  * s(n_rc)d_r n_jc/(|n_rc| d_j)	(n_ji |n_rc| - s(n_rc)n_jc n_ri)/(|n_rc| d_j)
  *
+ * The last three steps on the other rows are performed by
+ * a single call to isl_seq_combine per row, such that
+ * the row can be updated in a single pass.
+ * The entry in the pivot column is computed by this call as well,
+ * but it is subsequently overwritten by the correct value.
  */
 int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 {
 	int i, j;
 	int sgn;
 	int t;
+	isl_int c;
 	isl_ctx *ctx;
 	struct isl_mat *mat = tab->mat;
 	struct isl_tab_var *var;
@@ -1145,6 +1195,7 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 	ctx = isl_tab_get_ctx(tab);
 	if (isl_ctx_next_operation(ctx) < 0)
 		return -1;
+	ctx->stats->tab_pivots++;
 
 	isl_int_swap(mat->row[row][0], mat->row[row][off + col]);
 	sgn = isl_int_sgn(mat->row[row][0]);
@@ -1159,25 +1210,22 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 		}
 	if (!isl_int_is_one(mat->row[row][0]))
 		isl_seq_normalize(mat->ctx, mat->row[row], off + tab->n_col);
+	isl_int_init(c);
 	for (i = 0; i < tab->n_row; ++i) {
 		if (i == row)
 			continue;
 		if (isl_int_is_zero(mat->row[i][off + col]))
 			continue;
+		isl_int_set(c, mat->row[i][off + col]);
 		isl_int_mul(mat->row[i][0], mat->row[i][0], mat->row[row][0]);
-		for (j = 0; j < off - 1 + tab->n_col; ++j) {
-			if (j == off - 1 + col)
-				continue;
-			isl_int_mul(mat->row[i][1 + j],
-				    mat->row[i][1 + j], mat->row[row][0]);
-			isl_int_addmul(mat->row[i][1 + j],
-				    mat->row[i][off + col], mat->row[row][1 + j]);
-		}
-		isl_int_mul(mat->row[i][off + col],
-			    mat->row[i][off + col], mat->row[row][off + col]);
+		isl_seq_combine(mat->row[i] + 1, mat->row[row][0],
+				mat->row[i] + 1, c, mat->row[row] + 1,
+				off - 1 + tab->n_col);
+		isl_int_mul(mat->row[i][off + col], c, mat->row[row][off + col]);
 		if (!isl_int_is_one(mat->row[i][0]))
 			isl_seq_normalize(mat->ctx, mat->row[i], off + tab->n_col);
 	}
+	isl_int_clear(c);
 	t = tab->row_var[row];
 	tab->row_var[row] = tab->col_var[col];
 	tab->col_var[col] = t;
@@ -3417,6 +3465,272 @@ int isl_tab_is_equality(struct isl_tab *tab, int con)
 					tab->n_col - tab->n_dead);
 }
 
+/* Return the position of the variable with index "v",
+ * encoded as in tab->row_var and tab->col_var,
+ * in a sequence of first the variables and then the constraints of "tab".
+ */
+static int var_pos(struct isl_tab *tab, int v)
+{
+	return v >= 0 ? v : tab->n_var + ~v;
+}
+
+/* Values smaller than this tolerance are considered to be zero
+ * in the floating point approximation of the simplex method.
+ */
+#define ISL_TAB_FLOAT_EPS	1e-9
+
+/* A dense floating point approximation of the non-redundant rows
+ * and the non-dead columns of a tableau.
+ *
+ * Row i of "a" (of length 1 + n_col) contains an approximation
+ * of the sample value of the variable row_var[i] followed
+ * by approximations of its coefficients in terms of the column variables.
+ * "row_var" and "col_var" use the same encoding as in the tableau.
+ * "obj" is the row of the variable that needs to be minimized.
+ */
+struct isl_tab_float {
+	int n_row;
+	int n_col;
+	int obj;
+	double *a;
+	int *row_var;
+	int *col_var;
+};
+
+static void isl_tab_float_clear(struct isl_tab_float *f)
+{
+	free(f->a);
+	free(f->row_var);
+	free(f->col_var);
+}
+
+/* Initialize "f" to a floating point approximation of "tab"
+ * for minimizing the row variable "obj".
+ * Return 0 if some of the values cannot be approximated
+ * by finite floating point numbers and 1 if "f" was initialized.
+ */
+static int isl_tab_float_init(struct isl_tab *tab, struct isl_tab_var *obj,
+	struct isl_tab_float *f)
+{
+	int i, j;
+	isl_ctx *ctx = isl_tab_get_ctx(tab);
+	unsigned off = 2 + tab->M;
+
+	f->n_row = tab->n_row - tab->n_redundant;
+	f->n_col = tab->n_col - tab->n_dead;
+	f->obj = obj->index - tab->n_redundant;
+	f->a = isl_alloc_array(ctx, double, f->n_row * (1 + f->n_col));
+	f->row_var = isl_alloc_array(ctx, int, f->n_row);
+	f->col_var = isl_alloc_array(ctx, int, f->n_col);
+	if ((f->n_row && (!f->a || !f->row_var)) || (f->n_col && !f->col_var))
+		return -1;
+
+	for (j = 0; j < f->n_col; ++j)
+		f->col_var[j] = tab->col_var[tab->n_dead + j];
+	for (i = 0; i < f->n_row; ++i) {
+		isl_int *row = tab->mat->row[tab->n_redundant + i];
+		double *a = f->a + i * (1 + f->n_col);
+		double d = isl_int_get_d(row[0]);
+
+		f->row_var[i] = tab->row_var[tab->n_redundant + i];
+		a[0] = isl_int_get_d(row[1]) / d;
+		for (j = 0; j < f->n_col; ++j)
+			a[1 + j] = isl_int_get_d(row[off + tab->n_dead + j]) / d;
+		for (j = 0; j < 1 + f->n_col; ++j)
+			if (!isfinite(a[j]))
+				return 0;
+	}
+
+	return 1;
+}
+
+/* Return the column of "f" that should be used to decrease
+ * the value of the objective row, or -1 if there is no such column.
+ * The column with the largest coefficient (in absolute value)
+ * among those that can be used to decrease the objective is chosen.
+ * "dir" is set to the direction (1 for an increase, -1 for a decrease)
+ * in which the corresponding variable needs to move.
+ */
+static int isl_tab_float_pivot_col(struct isl_tab *tab,
+	struct isl_tab_float *f, int *dir)
+{
+	int j, c = -1;
+	double best = ISL_TAB_FLOAT_EPS;
+	double *obj = f->a + f->obj * (1 + f->n_col);
+
+	for (j = 0; j < f->n_col; ++j) {
+		double v = obj[1 + j];
+
+		if (v > 0 && var_from_index(tab, f->col_var[j])->is_nonneg)
+			continue;
+		if (fabs(v) <= best)
+			continue;
+		best = fabs(v);
+		c = j;
+		*dir = v < 0 ? 1 : -1;
+	}
+
+	return c;
+}
+
+/* Return the row of "f" that limits the move of the variable
+ * in column "c" in direction "dir" the most,
+ * or -1 if no row imposes any limit.
+ */
+static int isl_tab_float_pivot_row(struct isl_tab *tab,
+	struct isl_tab_float *f, int c, int dir)
+{
+	int i, r = -1;
+	double best = 0;
+
+	for (i = 0; i < f->n_row; ++i) {
+		double *a = f->a + i * (1 + f->n_col);
+		double coef = dir * a[1 + c];
+		double bound;
+
+		if (i == f->obj)
+			continue;
+		if (!var_from_index(tab, f->row_var[i])->is_nonneg)
+			continue;
+		if (coef >= -ISL_TAB_FLOAT_EPS)
+			continue;
+		bound = (a[0] > 0 ? a[0] : 0) / -coef;
+		if (r < 0 || bound < best) {
+			r = i;
+			best = bound;
+		}
+	}
+
+	return r;
+}
+
+/* Interchange the variables associated to row "r" and column "c" of "f".
+ * This is the floating point version of isl_tab_pivot.
+ */
+static void isl_tab_float_pivot(struct isl_tab_float *f, int r, int c)
+{
+	int i, j, t;
+	int n = 1 + f->n_col;
+	double *pr = f->a + r * n;
+	double p = pr[1 + c];
+
+	for (j = 0; j < n; ++j)
+		pr[j] = -pr[j] / p;
+	pr[1 + c] = 1 / p;
+	for (i = 0; i < f->n_row; ++i) {
+		double *a = f->a + i * n;
+		double m = a[1 + c];
+
+		if (i == r || m == 0)
+			continue;
+		for (j = 0; j < n; ++j)
+			a[j] += m * pr[j];
+		a[1 + c] = m * pr[1 + c];
+	}
+
+	t = f->row_var[r];
+	f->row_var[r] = f->col_var[c];
+	f->col_var[c] = t;
+}
+
+/* Compute a guide for minimizing the row variable "obj" of "tab"
+ * if requested by the user through the tab_float_guide option.
+ *
+ * The guide is computed by running the simplex method
+ * on a floating point approximation of "tab", which is much cheaper
+ * than running it on the exact tableau, and by marking in *guide
+ * (indexed by var_pos) the variables that are basic in the final basis.
+ * This basis is (approximately) optimal, but the result is only used
+ * to select the pivots in the exact tableau, so approximation errors
+ * do not affect the optimal value, but only the number of exact pivots
+ * and the optimal basis that is reached.
+ *
+ * *guide is set to NULL if no guide is computed, i.e.,
+ * if the option is not set, if the tableau involves a big parameter or
+ * if the approximation does not find an optimal basis
+ * within a reasonable number of pivots.
+ */
+static isl_stat isl_tab_float_guide(struct isl_tab *tab,
+	struct isl_tab_var *obj, char **guide)
+{
+	int i, ok, n_iter;
+	isl_ctx *ctx = isl_tab_get_ctx(tab);
+	struct isl_tab_float f = { 0 };
+
+	*guide = NULL;
+	if (!ctx->opt->tab_float_guide || tab->M)
+		return isl_stat_ok;
+
+	ok = isl_tab_float_init(tab, obj, &f);
+	if (ok < 0)
+		goto error;
+
+	n_iter = 10 * (f.n_row + f.n_col);
+	for (; ok; --n_iter) {
+		int r, c, dir;
+
+		c = isl_tab_float_pivot_col(tab, &f, &dir);
+		if (c < 0)
+			break;
+		r = isl_tab_float_pivot_row(tab, &f, c, dir);
+		if (r < 0 || n_iter <= 0)
+			ok = 0;
+		else
+			isl_tab_float_pivot(&f, r, c);
+	}
+
+	if (ok) {
+		*guide = isl_calloc_array(ctx, char, tab->n_var + tab->n_con);
+		if (!*guide)
+			goto error;
+		for (i = 0; i < f.n_row; ++i)
+			(*guide)[var_pos(tab, f.row_var[i])] = 1;
+		ctx->stats->tab_float_guided++;
+	}
+
+	isl_tab_float_clear(&f);
+	return isl_stat_ok;
+error:
+	isl_tab_float_clear(&f);
+	return isl_stat_error;
+}
+
+/* Find a pivot (row and col) that will decrease the value
+ * of row variable "var", as in find_pivot, but giving preference
+ * to columns with variables that are marked in "guide",
+ * i.e., that are basic in an approximation of an optimal basis.
+ * Among such columns, the one with the smallest variable index is chosen.
+ * If there is no such column, then the choice is left to find_pivot.
+ */
+static void find_guided_pivot(struct isl_tab *tab, struct isl_tab_var *var,
+	char *guide, int *row, int *col)
+{
+	int j, r, c;
+	isl_int *tr;
+
+	tr = tab->mat->row[var->index] + 2 + tab->M;
+
+	c = -1;
+	for (j = tab->n_dead; j < tab->n_col; ++j) {
+		if (!guide[var_pos(tab, tab->col_var[j])])
+			continue;
+		if (isl_int_is_zero(tr[j]))
+			continue;
+		if (isl_int_is_pos(tr[j]) && var_from_col(tab, j)->is_nonneg)
+			continue;
+		if (c < 0 || tab->col_var[j] < tab->col_var[c])
+			c = j;
+	}
+	if (c < 0) {
+		find_pivot(tab, var, var, -1, row, col);
+		return;
+	}
+
+	r = pivot_row(tab, var, -isl_int_sgn(tr[c]), c);
+	*row = r < 0 ? var->index : r;
+	*col = c;
+}
+
 /* Return the minimal value of the affine expression "f" with denominator
  * "denom" in *opt, *opt_denom, assuming the tableau is not empty and
  * the expression cannot attain arbitrarily small values.
@@ -3426,15 +3740,27 @@ int isl_tab_is_equality(struct isl_tab *tab, int con)
  *
  * This function assumes that at least one more row and at least
  * one more element in the constraint array are available in the tableau.
+ *
+ * If a guide is computed by isl_tab_float_guide, then the pivots
+ * are first selected using this guide.  Since every such pivot
+ * is also a valid pivot of the exact simplex method and since
+ * the optimality of the final basis is determined by the exact
+ * tableau, the optimal value is the same as without the guide.
+ * The final basis, and therefore the optimal solution and
+ * the dual values, may be different if the optimum is not unique.
+ * The number of guided pivots is bounded to ensure termination
+ * in case the guide is inaccurate.
  */
 enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 	isl_int *f, isl_int denom, isl_int *opt, isl_int *opt_denom,
 	unsigned flags)
 {
 	int r;
+	int n_guided;
 	enum isl_lp_result res = isl_lp_ok;
 	struct isl_tab_var *var;
 	struct isl_tab_undo *snap;
+	char *guide;
 
 	if (!tab)
 		return isl_lp_error;
@@ -3447,9 +3773,15 @@ enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 	if (r < 0)
 		return isl_lp_error;
 	var = &tab->con[r];
+	if (isl_tab_float_guide(tab, var, &guide) < 0)
+		return isl_lp_error;
+	n_guided = tab->n_row + tab->n_col;
 	for (;;) {
 		int row, col;
-		find_pivot(tab, var, var, -1, &row, &col);
+		if (guide && n_guided-- > 0)
+			find_guided_pivot(tab, var, guide, &row, &col);
+		else
+			find_pivot(tab, var, var, -1, &row, &col);
 		if (row == var->index) {
 			res = isl_lp_unbounded;
 			break;
@@ -3457,8 +3789,10 @@ enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 		if (row == -1)
 			break;
 		if (isl_tab_pivot(tab, row, col) < 0)
-			return isl_lp_error;
+			goto error;
 	}
+	free(guide);
+	guide = NULL;
 	isl_int_mul(tab->mat->row[var->index][0],
 		    tab->mat->row[var->index][0], denom);
 	if (ISL_FL_ISSET(flags, ISL_TAB_SAVE_DUAL)) {
@@ -3467,7 +3801,7 @@ enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 		isl_vec_free(tab->dual);
 		tab->dual = isl_vec_alloc(tab->mat->ctx, 1 + tab->n_con);
 		if (!tab->dual)
-			return isl_lp_error;
+			goto error;
 		isl_int_set(tab->dual->el[0], tab->mat->row[var->index][0]);
 		for (i = 0; i < tab->n_con; ++i) {
 			int pos;
@@ -3494,6 +3828,9 @@ enum isl_lp_result isl_tab_min(struct isl_tab *tab,
 	if (isl_tab_rollback(tab, snap) < 0)
 		return isl_lp_error;
 	return res;
+error:
+	free(guide);
+	return isl_lp_error;
 }
 
 /* Is the constraint at position "con" marked as being redundant?
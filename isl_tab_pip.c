@@ -623,15 +623,20 @@ static isl_stat sol_dec_level_wrap(struct isl_tab_callback *cb)
  * the current state.  That is, dec_level will be called with
  * the context tableau in the same state as it is when inc_level
  * is called.
+ * Keep track of the maximal level reached in the statistics.
  */
 static void sol_inc_level(struct isl_sol *sol)
 {
+	isl_ctx *ctx;
 	struct isl_tab *tab;
 
 	if (sol->error)
 		return;
 
 	sol->level++;
+	ctx = isl_space_get_ctx(sol->space);
+	if (sol->level > ctx->stats->pip_max_level)
+		ctx->stats->pip_max_level = sol->level;
 	tab = sol->context->op->peek_tab(sol->context);
 	if (isl_tab_push_callback(tab, &sol->dec_level.callback) < 0)
 		sol->error = 1;
@@ -3950,6 +3955,16 @@ static void find_solutions(struct isl_sol *sol, struct isl_tab *tab);
  * we would have to keep in mind that we need to save the row signs
  * and that we need to do this before saving the current basis
  * such that the basis has been restore before we restore the row signs.
+ * Moreover, some operations on the main tableau, e.g., set_row_cst_to_div,
+ * modify rows in place without recording any undo information.
+ * Sharing rows between the copy and the original would similarly
+ * require all such in-place modifications to copy the row first.
+ * The copy made by isl_tab_dup is at least restricted to the part
+ * of the main tableau that is in use.
+ * Note that the two branches of a split cannot be explored concurrently
+ * since they share the context tableau (through its undo log),
+ * the partial solutions in "sol" (merged through callbacks on
+ * that undo log) and the isl_ctx.
  */
 static void find_in_pos(struct isl_sol *sol, struct isl_tab *tab, isl_int *ineq)
 {
@@ -3961,6 +3976,7 @@ static void find_in_pos(struct isl_sol *sol, struct isl_tab *tab, isl_int *ineq)
 	tab = isl_tab_dup(tab);
 	if (!tab)
 		goto error;
+	tab->mat->ctx->stats->pip_splits++;
 
 	saved = sol->context->op->save(sol->context);
 
@@ -5741,6 +5757,13 @@ error:
 	return NULL;
 }
 
+/* Return the isl_ctx to which "tl" belongs.
+ */
+isl_ctx *isl_tab_lexmin_get_ctx(__isl_keep isl_tab_lexmin *tl)
+{
+	return tl ? tl->ctx : NULL;
+}
+
 /* Return the dimension of the set represented by "tl".
  */
 int isl_tab_lexmin_dim(__isl_keep isl_tab_lexmin *tl)
@@ -19,7 +19,12 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
+#include <isl_config.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl_aff_private.h>
@@ -36,14 +41,19 @@
 #include <isl/schedule_node.h>
 #include <isl_options_private.h>
 #include <isl_vertices_private.h>
+#include <isl_vec_private.h>
 #include <isl/ast_build.h>
 #include <isl/val.h>
 #include <isl/ilp.h>
+#include <isl/lp.h>
 #include <isl_ast_build_expr.h>
 #include <isl/options.h>
 
 #include "isl_srcdir.c"
 
+#include <bset_to_bmap.c>
+#include <bset_from_bmap.c>
+
 #define ARRAY_SIZE(array) (sizeof(array)/sizeof(*array))
 
 static char *get_filename(isl_ctx *ctx, const char *name, const char *suffix) {
@@ -2202,6 +2212,11 @@ struct {
 		"(0 < a <= 700 and 360*floor(a/360) >= -340 + a) }" },
 	{ 0, "{ [a] : 0 < a <= 341 or "
 		"(0 < a <= 701 and 360*floor(a/360) >= -340 + a) }" },
+	{ 1, "{ [x, y] : 0 <= x <= 3 and 0 <= y <= 3 or "
+		"10 <= x <= 13 and 0 <= y <= 3 or 4 <= x <= 9 and 0 <= y <= 3 }" },
+	{ 0, "{ [x, y] : 0 <= x <= 3 and 0 <= y <= 3 or "
+		"10 <= x <= 13 and 0 <= y <= 3 or 20 <= x <= 23 and 0 <= y <= 3 }" },
+	{ 1, "{ [x] : x mod 2 = 0 and (0 <= x <= 4 or -4 <= x <= -2) }" },
 };
 
 /* A specialized coalescing test case that would result
@@ -2803,6 +2818,204 @@ static int test_isl_bool(isl_ctx *ctx)
 	return 0;
 }
 
+/* Perform some basic checks on child contexts of a frozen context.
+ *
+ * In particular, check that an identifier created in the parent
+ * before it was frozen is shared by the children,
+ * that identifiers created in different children are different,
+ * that computations can be performed independently in the children and
+ * that no new identifiers can be created in the frozen parent.
+ * Use a separate parent context since it needs to be frozen.
+ */
+static int test_ctx_child(isl_ctx *ctx)
+{
+	isl_ctx *parent, *child1, *child2;
+	isl_id *id, *id1, *id2;
+	isl_set *set1, *set2;
+	isl_bool equal;
+	int ok;
+
+	parent = isl_ctx_alloc();
+	if (!parent)
+		return -1;
+	isl_options_set_on_error(parent, ISL_ON_ERROR_CONTINUE);
+	id = isl_id_alloc(parent, "A", NULL);
+	if (isl_ctx_freeze(parent) < 0)
+		goto error;
+	child1 = isl_ctx_alloc_child(parent);
+	child2 = isl_ctx_alloc_child(parent);
+
+	id1 = isl_id_alloc(child1, "A", NULL);
+	id2 = isl_id_alloc(child2, "A", NULL);
+	ok = id && id1 == id && id2 == id;
+	isl_id_free(id1);
+	isl_id_free(id2);
+	id1 = isl_id_alloc(child1, "B", NULL);
+	id2 = isl_id_alloc(child2, "B", NULL);
+	ok = ok && id1 && id2 && id1 != id2 &&
+		isl_id_get_ctx(id1) == child1 && isl_id_get_ctx(id2) == child2;
+	isl_id_free(id1);
+	isl_id_free(id2);
+
+	set1 = isl_set_read_from_str(child1, "{ A[i] : 0 <= i < 10 }");
+	set2 = isl_set_read_from_str(child2, "{ A[i] : 0 <= i < 10 }");
+	set1 = isl_set_coalesce(isl_set_union(set1,
+		isl_set_read_from_str(child1, "{ A[i] : 10 <= i < 20 }")));
+	set2 = isl_set_lower_bound_si(set2, isl_dim_set, 0, 5);
+	equal = isl_set_has_equal_space(set1, set2);
+	isl_set_free(set1);
+	isl_set_free(set2);
+	if (equal < 0 || !equal)
+		ok = 0;
+
+	id1 = isl_id_alloc(parent, "C", NULL);
+	if (id1)
+		ok = 0;
+	isl_id_free(id1);
+
+	isl_id_free(id);
+	isl_ctx_free(child1);
+	isl_ctx_free(child2);
+	isl_ctx_free(parent);
+
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected behavior of child contexts", return -1);
+
+	return 0;
+error:
+	isl_id_free(id);
+	isl_ctx_free(parent);
+	return -1;
+}
+
+/* Sizes of vectors that are allocated in test_blk_cache,
+ * along with the size of a vector that should reuse the block
+ * of the first vector after it has been freed.
+ */
+static struct {
+	int n;
+	int reuse;
+} blk_cache_tests[] = {
+	{ 3, 4 },
+	{ 100, 110 },
+	{ 1000, 1024 },
+	{ 1100, 1280 },
+};
+
+/* Check that a freed block is reused for a block of the same size class,
+ * that the block cache statistics are updated accordingly and
+ * that rounding up the size of a large block to its size class
+ * adds at most a quarter of the requested size.
+ */
+static int test_blk_cache(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(blk_cache_tests); ++i) {
+		int n = blk_cache_tests[i].n;
+		long hit, malloc;
+		isl_vec *vec;
+		size_t size;
+
+		vec = isl_vec_alloc(ctx, n);
+		if (!vec)
+			return -1;
+		size = vec->block.size;
+		isl_vec_free(vec);
+		if (size < n || (n > (1 << ISL_BLK_FINE) && 4 * size > 5 * n))
+			isl_die(ctx, isl_error_unknown,
+				"unexpected block size", return -1);
+		hit = isl_ctx_get_stat(ctx, isl_ctx_stat_blk_cache_hit);
+		malloc = isl_ctx_get_stat(ctx, isl_ctx_stat_blk_malloc);
+		vec = isl_vec_alloc(ctx, blk_cache_tests[i].reuse);
+		isl_vec_free(vec);
+		if (!vec || hit < 0 || malloc < 0)
+			return -1;
+		if (isl_ctx_get_stat(ctx, isl_ctx_stat_blk_cache_hit) != hit + 1 ||
+		    isl_ctx_get_stat(ctx, isl_ctx_stat_blk_malloc) != malloc)
+			isl_die(ctx, isl_error_unknown,
+				"freed block not reused", return -1);
+	}
+
+	return 0;
+}
+
+/* Allocate "n" vectors of size "size" in "ctx", free them again and
+ * store the number of block cache hits during the allocation in "hits".
+ */
+static isl_stat alloc_free_vecs(isl_ctx *ctx, int n, int size, long *hits)
+{
+	int i;
+	long hit;
+	isl_vec *vec[2 * ISL_BLK_CLASS_CACHE_SIZE];
+	isl_stat r = isl_stat_ok;
+
+	hit = isl_ctx_get_stat(ctx, isl_ctx_stat_blk_cache_hit);
+	if (hit < 0)
+		return isl_stat_error;
+	for (i = 0; i < n; ++i)
+		vec[i] = isl_vec_alloc(ctx, size);
+	*hits = isl_ctx_get_stat(ctx, isl_ctx_stat_blk_cache_hit) - hit;
+	for (i = 0; i < n; ++i) {
+		if (!vec[i])
+			r = isl_stat_error;
+		isl_vec_free(vec[i]);
+	}
+
+	return r;
+}
+
+/* Check that all freed blocks are kept inside a block retention scope,
+ * that the block cache is trimmed again when the outermost scope
+ * is closed and that closing a scope that was not opened
+ * results in an error.
+ * The number of blocks that are kept is derived from
+ * the number of block cache hits when allocating the same number
+ * of blocks again.
+ */
+static int test_block_retention(isl_ctx *ctx)
+{
+	int n = 2 * ISL_BLK_CLASS_CACHE_SIZE;
+	int on_error;
+	long hits;
+	isl_stat r;
+
+	if (isl_ctx_push_block_retention(ctx) < 0 ||
+	    isl_ctx_push_block_retention(ctx) < 0)
+		return -1;
+	if (alloc_free_vecs(ctx, n, 3, &hits) < 0 ||
+	    alloc_free_vecs(ctx, n, 3, &hits) < 0)
+		return -1;
+	if (hits != n)
+		isl_die(ctx, isl_error_unknown,
+			"freed blocks not kept inside scope", return -1);
+	if (isl_ctx_pop_block_retention(ctx) < 0)
+		return -1;
+	if (alloc_free_vecs(ctx, n, 3, &hits) < 0)
+		return -1;
+	if (hits != n)
+		isl_die(ctx, isl_error_unknown,
+			"cache trimmed inside scope", return -1);
+	if (isl_ctx_pop_block_retention(ctx) < 0)
+		return -1;
+	if (alloc_free_vecs(ctx, n, 3, &hits) < 0)
+		return -1;
+	if (hits > ISL_BLK_CLASS_CACHE_SIZE)
+		isl_die(ctx, isl_error_unknown,
+			"cache not trimmed after scope", return -1);
+
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	r = isl_ctx_pop_block_retention(ctx);
+	isl_options_set_on_error(ctx, on_error);
+	if (r >= 0)
+		isl_die(ctx, isl_error_unknown,
+			"closing unopened scope should fail", return -1);
+
+	return 0;
+}
+
 static int test_lex(struct isl_ctx *ctx)
 {
 	isl_space *space;
@@ -2954,6 +3167,33 @@ static int test_lexmin(struct isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that the lexicographic minimum of a set where the sign
+ * of the solution depends on the parameter is computed by splitting
+ * the context and that this split is recorded in the statistics,
+ * along with the nesting level it was performed at.
+ */
+static int test_pip_stats(isl_ctx *ctx)
+{
+	long splits;
+	isl_set *set;
+
+	splits = ctx->stats->pip_splits;
+	set = isl_set_read_from_str(ctx,
+				"[n] -> { [i] : 2i >= n and 0 <= i <= 10 }");
+	set = isl_set_lexmin(set);
+	isl_set_free(set);
+	if (!set)
+		return -1;
+	if (ctx->stats->pip_splits == splits)
+		isl_die(ctx, isl_error_unknown,
+			"context split not recorded", return -1);
+	if (ctx->stats->pip_max_level < 1)
+		isl_die(ctx, isl_error_unknown,
+			"nesting level not recorded", return -1);
+
+	return 0;
+}
+
 /* Inputs for isl_pw_multi_aff_max_multi_val tests.
  * "pma" is the input.
  * "res" is the expected result.
@@ -4137,6 +4377,166 @@ static int test_subtract(isl_ctx *ctx)
 	return 0;
 }
 
+/* Inputs for subtraction and subset tests where some pairs
+ * of basic sets are separated by a pair of opposite constraints.
+ * "subset" is set if "minuend" is a subset of "subtrahend".
+ */
+struct {
+	const char *minuend;
+	const char *subtrahend;
+	const char *difference;
+	int subset;
+} subtract_pruning_tests[] = {
+	{ "[n] -> { [i] : 0 <= i < n; [i] : n <= i < 2n }",
+	  "[n] -> { [i] : 0 <= i < n; [i] : 2n <= i < 3n }",
+	  "[n] -> { [i] : n <= i < 2n }", 0 },
+	{ "[n] -> { [i, j] : i = n and 0 <= j < 10; [i, j] : i = n + 1 }",
+	  "[n] -> { [i, j] : i = n + 1; [i, j] : i = n + 2; "
+		"[i, j] : i = n and 0 <= j < 10 }",
+	  "[n] -> { [i, j] : false }", 1 },
+	{ "{ [i] : exists (e : i = 2e) and 0 <= i <= 10 }",
+	  "{ [i] : 0 <= i <= 4; [i] : i >= 11; [i] : 6 <= i <= 8 }",
+	  "{ [10] }", 0 },
+	{ "{ [i, j] : i + j = 5 and 0 <= i <= 5 }",
+	  "{ [i, j] : i + j >= 6; [i, j] : i + j = 4; [i, j] : i >= 3 }",
+	  "{ [i, j] : i + j = 5 and 0 <= i <= 2 }", 0 },
+};
+
+/* Check that subtraction and subset tests produce the expected results
+ * on inputs where some of the pairs of basic sets can be pruned and
+ * that some pairs are effectively pruned.
+ */
+static int test_subtract_pruning(isl_ctx *ctx)
+{
+	int i;
+	long pruned;
+
+	pruned = ctx->stats->subtract_pruned_pairs;
+	for (i = 0; i < ARRAY_SIZE(subtract_pruning_tests); ++i) {
+		isl_set *set1, *set2, *diff;
+		isl_bool equal, subset;
+
+		set1 = isl_set_read_from_str(ctx,
+				subtract_pruning_tests[i].minuend);
+		set2 = isl_set_read_from_str(ctx,
+				subtract_pruning_tests[i].subtrahend);
+		diff = isl_set_read_from_str(ctx,
+				subtract_pruning_tests[i].difference);
+		subset = isl_set_is_subset(set1, set2);
+		set1 = isl_set_subtract(set1, set2);
+		equal = isl_set_is_equal(set1, diff);
+		isl_set_free(set1);
+		isl_set_free(diff);
+		if (equal < 0 || subset < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"incorrect subtract result", return -1);
+		if (subset != subtract_pruning_tests[i].subset)
+			isl_die(ctx, isl_error_unknown,
+				"incorrect subset result", return -1);
+	}
+	if (pruned == ctx->stats->subtract_pruned_pairs)
+		isl_die(ctx, isl_error_unknown,
+			"no pairs pruned", return -1);
+
+	return 0;
+}
+
+/* Check that isl_basic_set_is_empty and isl_basic_set_remove_redundancies
+ * on a copy of "str" that was read in separately
+ * produce the same result as on "str" itself,
+ * that the emptiness test returns "empty_expected" and
+ * that the second call gets its result from the basic map cache
+ * if "hit_expected" is set or that it misses the cache otherwise.
+ */
+static isl_stat check_basic_map_cache(isl_ctx *ctx, const char *str,
+	int empty_expected, int hit_expected)
+{
+	int i;
+	long hit, miss;
+	isl_bool empty[2];
+	isl_bool equal;
+	isl_basic_set *bset[2];
+
+	for (i = 0; i < 2; ++i) {
+		bset[i] = isl_basic_set_read_from_str(ctx, str);
+		hit = ctx->stats->basic_map_cache_hit;
+		miss = ctx->stats->basic_map_cache_miss;
+		empty[i] = isl_basic_set_is_empty(bset[i]);
+		bset[i] = isl_basic_set_remove_redundancies(bset[i]);
+		if (empty[i] < 0 || !bset[i])
+			goto error;
+	}
+	if (hit_expected && hit == ctx->stats->basic_map_cache_hit)
+		isl_die(ctx, isl_error_unknown,
+			"result not found in cache", goto error);
+	if (!hit_expected && miss == ctx->stats->basic_map_cache_miss)
+		isl_die(ctx, isl_error_unknown,
+			"result unexpectedly found in cache", goto error);
+	if (empty[0] != empty_expected || empty[1] != empty_expected)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected emptiness", goto error);
+	equal = isl_basic_set_plain_is_equal(bset[0], bset[1]);
+	if (equal < 0)
+		goto error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"inconsistent redundancy removal", goto error);
+
+	isl_basic_set_free(bset[0]);
+	isl_basic_set_free(bset[1]);
+	return isl_stat_ok;
+error:
+	isl_basic_set_free(bset[0]);
+	isl_basic_set_free(bset[1]);
+	return isl_stat_error;
+}
+
+/* Basic sets for use in check_basic_map_cache,
+ * along with whether they are empty.
+ */
+static struct {
+	const char *set;
+	int empty;
+} basic_map_cache_tests[] = {
+	{ "{ [x, y] : 0 <= x <= 10 and 0 <= y <= 10 and x + y >= 5 and "
+		"x + y >= 0 }", 0 },
+	{ "{ [x, y] : 1 <= 3x + 5y <= 2 and -10 <= x, y <= 10 }", 0 },
+	{ "{ [x, y] : 0 <= x, y <= 10 and x + y >= 21 }", 1 },
+	{ "[n] -> { [x] : exists (e : x = 3e) and 0 <= x <= n and "
+		"x >= -n }", 0 },
+};
+
+/* Check that the basic map cache returns the expected results,
+ * both with a cache that is large enough to hold all results and
+ * with a cache that is too small to hold any of them.
+ * In the latter case, every lookup should be a miss.
+ * The large cache is tried first, such that the results
+ * it holds need to be evicted when the size of the cache is reduced.
+ */
+static int test_basic_map_cache(isl_ctx *ctx)
+{
+	int i;
+	int size;
+	int r = 0;
+
+	size = isl_options_get_basic_map_cache_size(ctx);
+	isl_options_set_basic_map_cache_size(ctx, 1 << 20);
+	for (i = 0; r == 0 && i < ARRAY_SIZE(basic_map_cache_tests); ++i)
+		if (check_basic_map_cache(ctx, basic_map_cache_tests[i].set,
+				basic_map_cache_tests[i].empty, 1) < 0)
+			r = -1;
+	isl_options_set_basic_map_cache_size(ctx, 1);
+	for (i = 0; r == 0 && i < ARRAY_SIZE(basic_map_cache_tests); ++i)
+		if (check_basic_map_cache(ctx, basic_map_cache_tests[i].set,
+				basic_map_cache_tests[i].empty, 0) < 0)
+			r = -1;
+	isl_options_set_basic_map_cache_size(ctx, size);
+
+	return r;
+}
+
 /* Check that intersecting the empty basic set with another basic set
  * does not increase the number of constraints.  In particular,
  * the empty basic set should maintain its canonical representation.
@@ -4179,6 +4579,60 @@ static isl_stat test_intersect_2(isl_ctx *ctx)
 	return isl_stat_ok;
 }
 
+/* Check that intersecting a basic set without redundant constraints
+ * with a basic set that only has constraints that are redundant
+ * with respect to the first basic set returns the first basic set
+ * without any redundant constraints and that the result is still
+ * correct if some constraints of the second basic set are not redundant,
+ * when the intersect_drop_redundant option is set.
+ */
+static isl_stat test_intersect_3(isl_ctx *ctx)
+{
+	int i;
+	int drop;
+	isl_stat r = isl_stat_ok;
+	const char *str;
+	const char *extra[] = {
+		"{ [x, y] : x + y <= 25 and x >= -1 }",
+		"{ [x, y] : x + y <= 15 and x >= -1 }",
+		"{ [x, y] : 2x <= 1 }",
+	};
+
+	drop = isl_options_get_intersect_drop_redundant(ctx);
+	isl_options_set_intersect_drop_redundant(ctx, 1);
+	str = "{ [x, y] : 0 <= x <= 10 and 0 <= y <= 10 }";
+	for (i = 0; r >= 0 && i < ARRAY_SIZE(extra); ++i) {
+		isl_basic_set *bset1, *bset2, *res, *expected;
+		isl_size n1, n2;
+		isl_bool equal;
+
+		bset1 = isl_basic_set_read_from_str(ctx, str);
+		bset1 = isl_basic_set_remove_redundancies(bset1);
+		bset2 = isl_basic_set_read_from_str(ctx, extra[i]);
+		n1 = isl_basic_set_n_constraint(bset1);
+		expected = isl_basic_set_intersect(
+			isl_basic_set_read_from_str(ctx, str),
+			isl_basic_set_copy(bset2));
+		res = isl_basic_set_intersect(bset1, bset2);
+		n2 = isl_basic_set_n_constraint(res);
+		equal = isl_basic_set_is_equal(res, expected);
+		isl_basic_set_free(res);
+		isl_basic_set_free(expected);
+		if (n1 < 0 || n2 < 0 || equal < 0)
+			r = isl_stat_error;
+		else if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected intersection", r = isl_stat_error);
+		else if (i == 0 && n1 != n2)
+			isl_die(ctx, isl_error_unknown,
+				"redundant constraints added",
+				r = isl_stat_error);
+	}
+	isl_options_set_intersect_drop_redundant(ctx, drop);
+
+	return r;
+}
+
 /* Perform some intersection tests.
  */
 static int test_intersect(isl_ctx *ctx)
@@ -4187,6 +4641,8 @@ static int test_intersect(isl_ctx *ctx)
 		return -1;
 	if (test_intersect_2(ctx) < 0)
 		return -1;
+	if (test_intersect_3(ctx) < 0)
+		return -1;
 
 	return 0;
 }
@@ -5187,34 +5643,387 @@ int test_schedule(isl_ctx *ctx)
 	return 0;
 }
 
-/* Perform scheduling tests using the whole component scheduler.
+/* Perform scheduling tests using the whole component scheduler.
+ */
+static int test_schedule_whole(isl_ctx *ctx)
+{
+	int whole;
+	int r;
+
+	whole = isl_options_get_schedule_whole_component(ctx);
+	isl_options_set_schedule_whole_component(ctx, 1);
+	r = test_schedule(ctx);
+	isl_options_set_schedule_whole_component(ctx, whole);
+
+	return r;
+}
+
+/* Perform scheduling tests using the incremental scheduler.
+ */
+static int test_schedule_incremental(isl_ctx *ctx)
+{
+	int whole;
+	int r;
+
+	whole = isl_options_get_schedule_whole_component(ctx);
+	isl_options_set_schedule_whole_component(ctx, 0);
+	r = test_schedule(ctx);
+	isl_options_set_schedule_whole_component(ctx, whole);
+
+	return r;
+}
+
+/* Construct schedule constraints on "domain" with
+ * the given validity and coincidence constraints.
+ */
+static __isl_give isl_schedule_constraints *construct_schedule_constraints(
+	isl_ctx *ctx, const char *domain, const char *validity,
+	const char *coincidence)
+{
+	isl_union_set *dom;
+	isl_union_map *dep;
+	isl_schedule_constraints *sc;
+
+	dom = isl_union_set_read_from_str(ctx, domain);
+	sc = isl_schedule_constraints_on_domain(dom);
+	dep = isl_union_map_read_from_str(ctx, validity);
+	sc = isl_schedule_constraints_set_validity(sc, dep);
+	dep = isl_union_map_read_from_str(ctx, coincidence);
+	sc = isl_schedule_constraints_set_coincidence(sc, dep);
+
+	return sc;
+}
+
+/* Check that "schedule" respects the dependences "validity".
+ */
+static isl_stat check_respects(isl_ctx *ctx, __isl_keep isl_schedule *schedule,
+	const char *validity)
+{
+	isl_union_map *map, *lt, *dep;
+	isl_bool ok;
+
+	map = isl_schedule_get_map(schedule);
+	lt = isl_union_map_lex_lt_union_map(isl_union_map_copy(map), map);
+	dep = isl_union_map_read_from_str(ctx, validity);
+	ok = isl_union_map_is_subset(dep, lt);
+	isl_union_map_free(dep);
+	isl_union_map_free(lt);
+	if (ok < 0)
+		return isl_stat_error;
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"schedule does not respect dependences",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that isl_schedule_constraints_update_schedule reuses
+ * the part of a previously computed schedule that is still valid,
+ * updating the coincidence properties as needed, and
+ * that it recomputes the part that is no longer valid.
+ * The statement B is independent of A, so the updated schedule
+ * is expected to consist of a set node with the band of
+ * the original schedule in the first child.
+ */
+static int test_schedule_update(isl_ctx *ctx)
+{
+	const char *domain, *validity, *coincidence;
+	isl_schedule_constraints *sc;
+	isl_schedule *schedule, *updated;
+	isl_schedule_node *node;
+	isl_union_map *map1, *map2;
+	isl_bool equal, coincident;
+
+	domain = "{ A[i,j] : 0 <= i,j < 10 }";
+	validity = "{ A[i,j] -> A[i,j+1] }";
+	sc = construct_schedule_constraints(ctx, domain, validity, validity);
+	schedule = isl_schedule_constraints_compute_schedule(sc);
+
+	domain = "{ A[i,j] : 0 <= i,j < 10; B[i] : 0 <= i < 10 }";
+	coincidence = "{ A[i,j] -> A[i,j+1]; A[i,j] -> A[i+1,j] }";
+	sc = construct_schedule_constraints(ctx, domain, validity, coincidence);
+	updated = isl_schedule_constraints_update_schedule(sc,
+						isl_schedule_copy(schedule));
+	node = isl_schedule_get_root(updated);
+	node = isl_schedule_node_child(node, 0);
+	node = isl_schedule_node_child(node, 0);
+	node = isl_schedule_node_child(node, 0);
+	coincident = isl_schedule_node_band_member_get_coincident(node, 0);
+	map2 = isl_schedule_node_band_get_partial_schedule_union_map(node);
+	isl_schedule_node_free(node);
+	node = isl_schedule_get_root(schedule);
+	node = isl_schedule_node_child(node, 0);
+	map1 = isl_schedule_node_band_get_partial_schedule_union_map(node);
+	isl_schedule_node_free(node);
+	equal = isl_union_map_is_equal(map1, map2);
+	isl_union_map_free(map1);
+	isl_union_map_free(map2);
+	isl_schedule_free(updated);
+	if (equal < 0 || coincident < 0) {
+		isl_schedule_free(schedule);
+		return -1;
+	}
+	if (!equal || coincident)
+		isl_die(ctx, isl_error_unknown, "schedule not properly reused",
+			goto error);
+
+	domain = "{ A[i,j] : 0 <= i,j < 10 }";
+	validity = "{ A[i,j] -> A[i,j-1] }";
+	sc = construct_schedule_constraints(ctx, domain, validity, "{}");
+	updated = isl_schedule_constraints_update_schedule(sc, schedule);
+	if (check_respects(ctx, updated, validity) < 0) {
+		isl_schedule_free(updated);
+		return -1;
+	}
+	isl_schedule_free(updated);
+
+	return 0;
+error:
+	isl_schedule_free(schedule);
+	return -1;
+}
+
+#ifdef HAVE_MKDTEMP
+/* Return the name of the file in the on-disk schedule cache "dir"
+ * that holds the entry of every key if the cache has a single slot.
+ */
+static char *cache_entry_name(isl_ctx *ctx, const char *dir)
+{
+	size_t len;
+	char *name;
+
+	len = strlen(dir) + 20;
+	name = isl_alloc_array(ctx, char, len);
+	if (!name)
+		return NULL;
+	snprintf(name, len, "%s/isl-schedule-0", dir);
+
+	return name;
+}
+
+/* Check that a corrupt entry in the on-disk schedule cache "dir" is
+ * treated as a cache miss, without reporting an error.
+ * The entry has the right cache key, but it is followed by
+ * something that is not a schedule.
+ * The cache has a single slot, so that the name of the cache file
+ * is known.
+ */
+static int test_schedule_cache_corrupt(isl_ctx *ctx, const char *dir)
+{
+	isl_schedule_constraints *sc;
+	isl_schedule *schedule;
+	FILE *out;
+	char *key, *name;
+
+	sc = construct_schedule_constraints(ctx,
+		"{ A[i] : 0 <= i < 10; B[i] : 0 <= i < 10 }",
+		"{ A[i] -> B[i] }", "{}");
+	key = isl_schedule_constraints_get_cache_key(sc);
+	name = cache_entry_name(ctx, dir);
+	out = key && name ? fopen(name, "wb") : NULL;
+	if (out) {
+		fprintf(out, "%lu\n%s{ domain: [", (unsigned long) strlen(key),
+			key);
+		fclose(out);
+	}
+	free(key);
+	free(name);
+	if (!out) {
+		isl_schedule_constraints_free(sc);
+		return -1;
+	}
+	isl_ctx_reset_error(ctx);
+	schedule = isl_schedule_constraints_compute_schedule_cached(sc, dir);
+	isl_schedule_free(schedule);
+	if (!schedule)
+		return -1;
+	if (isl_ctx_last_error(ctx) != isl_error_none)
+		isl_die(ctx, isl_error_unknown,
+			"corrupt cache entry reported as error", return -1);
+
+	return 0;
+}
+
+/* Check that a schedule for "sc1" stored in the on-disk schedule cache
+ * "dir" is reused for "sc2", which has the same cache key,
+ * without running the scheduler.
+ */
+static int test_schedule_cache_reuse(isl_ctx *ctx, const char *dir,
+	__isl_take isl_schedule_constraints *sc1,
+	__isl_take isl_schedule_constraints *sc2)
+{
+	isl_schedule *schedule1, *schedule2;
+	long n_lp;
+	int equal;
+
+	schedule1 = isl_schedule_constraints_compute_schedule_cached(sc1, dir);
+	n_lp = isl_ctx_get_stat(ctx, isl_ctx_stat_sched_lp);
+	schedule2 = isl_schedule_constraints_compute_schedule_cached(sc2, dir);
+	if (n_lp >= 0 && isl_ctx_get_stat(ctx, isl_ctx_stat_sched_lp) != n_lp)
+		n_lp = -1;
+	equal = schedule1 && schedule2 &&
+		isl_schedule_plain_is_equal(schedule1, schedule2);
+	isl_schedule_free(schedule1);
+	isl_schedule_free(schedule2);
+	if (!equal || n_lp < 0)
+		isl_die(ctx, isl_error_unknown, "schedule not read from cache",
+			return -1);
+
+	return 0;
+}
+
+/* Perform the on-disk schedule cache tests on "sc1" and "sc2",
+ * which have the same cache key, in a private directory
+ * that is created for this purpose and removed afterwards.
+ * A single cache slot is used, so that the name of the cache file
+ * is known and can be removed before removing the directory.
+ */
+static int test_schedule_cache_dir(isl_ctx *ctx,
+	__isl_take isl_schedule_constraints *sc1,
+	__isl_take isl_schedule_constraints *sc2)
+{
+	const char *tmpdir;
+	char *dir, *name;
+	size_t len;
+	int slots;
+	int r;
+
+	tmpdir = getenv("TMPDIR");
+	if (!tmpdir || !*tmpdir)
+		tmpdir = "/tmp";
+	len = strlen(tmpdir) + 20;
+	dir = isl_alloc_array(ctx, char, len);
+	if (dir)
+		snprintf(dir, len, "%s/isl-test-XXXXXX", tmpdir);
+	if (!dir || !mkdtemp(dir)) {
+		free(dir);
+		isl_schedule_constraints_free(sc1);
+		isl_schedule_constraints_free(sc2);
+		isl_die(ctx, isl_error_unknown,
+			"unable to create cache directory", return -1);
+	}
+
+	slots = isl_options_get_schedule_cache_slots(ctx);
+	isl_options_set_schedule_cache_slots(ctx, 1);
+	r = test_schedule_cache_reuse(ctx, dir, sc1, sc2);
+	if (r >= 0)
+		r = test_schedule_cache_corrupt(ctx, dir);
+	isl_options_set_schedule_cache_slots(ctx, slots);
+
+	name = cache_entry_name(ctx, dir);
+	if (name)
+		remove(name);
+	free(name);
+	if (rmdir(dir) != 0)
+		r = -1;
+	free(dir);
+
+	return r;
+}
+#else
+/* The on-disk schedule cache tests require mkdtemp for creating
+ * a private cache directory.  Skip them on systems without mkdtemp.
+ */
+static int test_schedule_cache_dir(isl_ctx *ctx,
+	__isl_take isl_schedule_constraints *sc1,
+	__isl_take isl_schedule_constraints *sc2)
+{
+	isl_schedule_constraints_free(sc1);
+	isl_schedule_constraints_free(sc2);
+	return 0;
+}
+#endif
+
+/* Check that the cache keys of schedule constraints do not depend
+ * on the order in which the constraints are specified and
+ * perform the tests on the on-disk schedule cache.
+ */
+static int test_schedule_cache(isl_ctx *ctx)
+{
+	const char *validity;
+	isl_schedule_constraints *sc1, *sc2;
+	char *key1, *key2;
+	int equal;
+
+	validity = "{ A[i] -> B[i]; B[i] -> A[i + 1] }";
+	sc1 = construct_schedule_constraints(ctx,
+		"{ A[i] : 0 <= i < 10; B[i] : 0 <= i < 10 }", validity, "{}");
+	validity = "{ B[i] -> A[i + 1]; A[i] -> B[i] }";
+	sc2 = construct_schedule_constraints(ctx,
+		"{ B[i] : i < 10 and i >= 0; A[i] : 0 <= i < 10 }",
+		validity, "{}");
+	key1 = isl_schedule_constraints_get_cache_key(sc1);
+	key2 = isl_schedule_constraints_get_cache_key(sc2);
+	equal = key1 && key2 && !strcmp(key1, key2);
+	free(key1);
+	free(key2);
+	if (!equal) {
+		isl_schedule_constraints_free(sc1);
+		isl_schedule_constraints_free(sc2);
+		isl_die(ctx, isl_error_unknown, "unexpected cache keys",
+			return -1);
+	}
+
+	return test_schedule_cache_dir(ctx, sc1, sc2);
+}
+
+/* Compute a schedule for the given domain and validity constraints
+ * under a budget of a single operation per component and
+ * check that the scheduler falls back to a schedule
+ * that still respects the validity constraints.
+ * Exhausting the budget should not be reported as an error,
+ * so the computation should not abort, even if
+ * the on_error option is set to abort.
  */
-static int test_schedule_whole(isl_ctx *ctx)
+static int test_schedule_budget_one(isl_ctx *ctx, const char *domain,
+	const char *validity)
 {
-	int whole;
-	int r;
+	isl_schedule_constraints *sc;
+	isl_schedule *schedule;
+	long n_fallback;
+	int max, on_error;
+	isl_stat r;
 
-	whole = isl_options_get_schedule_whole_component(ctx);
-	isl_options_set_schedule_whole_component(ctx, 1);
-	r = test_schedule(ctx);
-	isl_options_set_schedule_whole_component(ctx, whole);
+	n_fallback = isl_ctx_get_stat(ctx, isl_ctx_stat_sched_fallback);
+	if (n_fallback < 0)
+		return -1;
 
-	return r;
+	max = isl_options_get_schedule_max_operations(ctx);
+	on_error = isl_options_get_on_error(ctx);
+	isl_options_set_schedule_max_operations(ctx, 1);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_ABORT);
+	sc = construct_schedule_constraints(ctx, domain, validity, "{}");
+	schedule = isl_schedule_constraints_compute_schedule(sc);
+	isl_options_set_on_error(ctx, on_error);
+	isl_options_set_schedule_max_operations(ctx, max);
+
+	r = check_respects(ctx, schedule, validity);
+	isl_schedule_free(schedule);
+	if (r < 0)
+		return -1;
+	if (isl_ctx_get_stat(ctx, isl_ctx_stat_sched_fallback) <= n_fallback)
+		isl_die(ctx, isl_error_unknown, "budget not exhausted",
+			return -1);
+
+	return 0;
 }
 
-/* Perform scheduling tests using the incremental scheduler.
+/* Check that the scheduler produces valid schedules when
+ * the schedule_max_operations budget is exhausted, both
+ * in a case where the fallback identity schedule is valid and
+ * in a case where it is not.
  */
-static int test_schedule_incremental(isl_ctx *ctx)
+static int test_schedule_budget(isl_ctx *ctx)
 {
-	int whole;
-	int r;
-
-	whole = isl_options_get_schedule_whole_component(ctx);
-	isl_options_set_schedule_whole_component(ctx, 0);
-	r = test_schedule(ctx);
-	isl_options_set_schedule_whole_component(ctx, whole);
-
-	return r;
+	if (test_schedule_budget_one(ctx,
+		    "{ A[i,j] : 0 <= i,j < 10; B[i] : 0 <= i < 10 }",
+		    "{ A[i,j] -> A[i,j+1]; A[i,j] -> A[i+1,j]; "
+		    "A[i,9] -> B[i] }") < 0)
+		return -1;
+	if (test_schedule_budget_one(ctx, "{ A[i,j] : 0 <= i,j < 10 }",
+		    "{ A[i,j] -> A[i-1,j+1] }") < 0)
+		return -1;
+	return 0;
 }
 
 int test_plain_injective(isl_ctx *ctx, const char *str, int injective)
@@ -7979,14 +8788,65 @@ static isl_stat test_union_set_contains(isl_ctx *ctx)
 	return isl_stat_ok;
 }
 
+/* Check that maps with identical spaces in different union maps
+ * share the same space object when spaces are being interned and
+ * that modifying one of them does not affect the other.
+ */
+static isl_stat check_intern_spaces(isl_ctx *ctx)
+{
+	const char *str;
+	isl_space *space;
+	isl_union_map *umap1, *umap2;
+	isl_map *map1, *map2;
+	isl_bool shared;
+	int equal;
+
+	str = "[N] -> { A[i] -> B[j] : i < j < N; C[i] -> D[] }";
+	umap1 = isl_union_map_read_from_str(ctx, str);
+	str = "[N] -> { A[i] -> B[j] : i > j > N }";
+	umap2 = isl_union_map_read_from_str(ctx, str);
+	space = isl_space_read_from_str(ctx, "[N] -> { A[i] -> B[j] }");
+	map1 = isl_union_map_extract_map(umap1, isl_space_copy(space));
+	map2 = isl_union_map_extract_map(umap2, space);
+	isl_union_map_free(umap1);
+	isl_union_map_free(umap2);
+	shared = isl_bool_ok(isl_map_peek_space(map1) ==
+				isl_map_peek_space(map2));
+	map1 = isl_map_set_tuple_name(map1, isl_dim_in, "X");
+	str = "[N] -> { A[i] -> B[j] : i > j > N }";
+	equal = map_check_equal(map2, str);
+	isl_map_free(map1);
+	isl_map_free(map2);
+
+	if (equal < 0)
+		return isl_stat_error;
+	if (!shared)
+		isl_die(ctx, isl_error_unknown, "spaces not shared",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
 /* Perform basic tests of operations on isl_union_map or isl_union_set.
+ * Perform the tests on binary operations both with and
+ * without interning spaces.
  */
 static int test_union_map(isl_ctx *ctx)
 {
+	int intern;
+
 	if (test_bin_union_map(ctx) < 0)
 		return -1;
 	if (test_union_set_contains(ctx) < 0)
 		return -1;
+
+	intern = isl_options_get_intern_spaces(ctx);
+	isl_options_set_intern_spaces(ctx, 1);
+	if (test_bin_union_map(ctx) < 0 || check_intern_spaces(ctx) < 0) {
+		isl_options_set_intern_spaces(ctx, intern);
+		return -1;
+	}
+	isl_options_set_intern_spaces(ctx, intern);
+
 	return 0;
 }
 
@@ -10550,8 +11410,31 @@ static int test_tile(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that the range hash of "space" is equal to the hash
+ * of the range of "space", both ignoring parameters.
+ */
+static isl_stat check_range_hash(isl_ctx *ctx, __isl_take isl_space *space)
+{
+	uint32_t hash1, hash2;
+
+	hash1 = isl_space_get_tuple_range_hash(space);
+	space = isl_space_range(space);
+	hash2 = isl_space_get_tuple_hash(space);
+	isl_space_free(space);
+
+	if (!space)
+		return isl_stat_error;
+	if (hash1 != hash2)
+		isl_die(ctx, isl_error_unknown,
+			"range hash not equal to hash of range",
+			return isl_stat_error);
+
+	return isl_stat_ok;
+}
+
 /* Check that the domain hash of a space is equal to the hash
  * of the domain of the space, both ignoring parameters.
+ * Perform a similar check on the range hash.
  */
 static int test_domain_hash(isl_ctx *ctx)
 {
@@ -10562,6 +11445,8 @@ static int test_domain_hash(isl_ctx *ctx)
 	map = isl_map_read_from_str(ctx, "[n] -> { A[B[x] -> C[]] -> D[] }");
 	space = isl_map_get_space(map);
 	isl_map_free(map);
+	if (check_range_hash(ctx, isl_space_reverse(isl_space_copy(space))) < 0)
+		return -1;
 	hash1 = isl_space_get_tuple_domain_hash(space);
 	space = isl_space_domain(space);
 	hash2 = isl_space_get_tuple_hash(space);
@@ -10688,6 +11573,487 @@ static int test_chambers(isl_ctx *ctx)
 	return 0;
 }
 
+/* Sets and objectives for use in test_tab_float_guide.
+ */
+static struct {
+	const char *set;
+	const char *obj;
+} tab_float_guide_tests[] = {
+	{ "{ [x, y] : 0 <= x <= 10 and 0 <= y <= 10 and x + y <= 15 }",
+	  "{ [x, y] -> [(x + 2y)] }" },
+	{ "{ [x, y, z] : x, y, z >= 0 and x + y + z <= 10 and x - y <= 3 }",
+	  "{ [x, y, z] -> [(3x - y + 2z)] }" },
+	{ "{ [x, y, z] : 2x + 3y - z >= 4 and -3 <= x - y <= 5 and "
+		"0 <= z <= 7 and y <= 12 }",
+	  "{ [x, y, z] -> [(x + y - 3z)] }" },
+};
+
+/* Check that the minimal and maximal values of "obj" over "set"
+ * are the same with and without guiding the exact simplex method
+ * by a floating point approximation and that the guidance is used
+ * if and only if "guided" is set.
+ */
+static isl_stat check_tab_float_guide(isl_ctx *ctx, const char *set,
+	const char *obj, int guided)
+{
+	int i, guide;
+	long n_guided;
+	isl_bool equal = isl_bool_true;
+
+	guide = isl_options_get_tab_float_guide(ctx);
+	n_guided = ctx->stats->tab_float_guided;
+	for (i = 0; equal == isl_bool_true && i < 2; ++i) {
+		isl_set *s;
+		isl_aff *aff;
+		isl_val *val[2];
+		int j;
+
+		for (j = 0; j < 2; ++j) {
+			isl_options_set_tab_float_guide(ctx, j);
+			s = isl_set_read_from_str(ctx, set);
+			aff = isl_aff_read_from_str(ctx, obj);
+			if (i == 0)
+				val[j] = isl_set_min_val(s, aff);
+			else
+				val[j] = isl_set_max_val(s, aff);
+			isl_set_free(s);
+			isl_aff_free(aff);
+		}
+		equal = isl_val_eq(val[0], val[1]);
+		isl_val_free(val[0]);
+		isl_val_free(val[1]);
+	}
+	isl_options_set_tab_float_guide(ctx, guide);
+
+	if (equal < 0)
+		return isl_stat_error;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"guided optimization produces different result",
+			return isl_stat_error);
+	if (guided != (ctx->stats->tab_float_guided != n_guided))
+		isl_die(ctx, isl_error_unknown,
+			"unexpected use of floating point guidance",
+			return isl_stat_error);
+	return isl_stat_ok;
+}
+
+/* Check that optimizations produce the same results when
+ * the exact simplex method is guided by a floating point approximation
+ * and that this guidance is effectively used.
+ * Also check an unbounded problem, for which the floating point
+ * approximation does not produce a guide, such that the exact
+ * simplex method falls back to its default pivoting strategy.
+ */
+static int test_tab_float_guide(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tab_float_guide_tests); ++i)
+		if (check_tab_float_guide(ctx, tab_float_guide_tests[i].set,
+				tab_float_guide_tests[i].obj, 1) < 0)
+			return -1;
+	if (check_tab_float_guide(ctx, "{ [x, y] : 0 <= y <= x + 5 }",
+				"{ [x, y] -> [(x - 2y)] }", 0) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Objective functions that are optimized in test_lp_solver.
+ */
+static const char *lp_solver_obj[] = {
+	"{ [x, y, z] -> [(x)] }",
+	"{ [x, y, z] -> [(x - y + 2z)/3] }",
+	"{ [x, y, z] -> [(-2x + 5 - y)] }",
+	"{ [x, y, z] -> [(z + y)/2] }",
+	"{ [x, y, z] -> [(3x + 2y + z - 7)] }",
+};
+
+/* Check that the minimal and maximal values of the objectives
+ * in lp_solver_obj computed by "solver" are the same
+ * as those computed over "bset" directly.
+ */
+static isl_stat check_lp_solver(__isl_keep isl_lp_solver *solver,
+	__isl_keep isl_basic_set *bset)
+{
+	int i, j;
+	isl_ctx *ctx = isl_basic_set_get_ctx(bset);
+
+	for (i = 0; i < ARRAY_SIZE(lp_solver_obj); ++i) {
+		isl_aff *obj;
+
+		obj = isl_aff_read_from_str(ctx, lp_solver_obj[i]);
+		for (j = 0; j < 2; ++j) {
+			isl_val *v1, *v2;
+			isl_bool equal;
+
+			if (j) {
+				v1 = isl_lp_solver_max_val(solver, obj);
+				v2 = isl_basic_set_max_lp_val(bset, obj);
+			} else {
+				v1 = isl_lp_solver_min_val(solver, obj);
+				v2 = isl_basic_set_min_lp_val(bset, obj);
+			}
+			equal = isl_val_eq(v1, v2);
+			if (equal >= 0 && !equal)
+				equal = isl_bool_ok(isl_val_is_nan(v1) &&
+						    isl_val_is_nan(v2));
+			isl_val_free(v1);
+			isl_val_free(v2);
+			if (equal < 0 || !equal)
+				isl_aff_free(obj);
+			if (equal < 0)
+				return isl_stat_error;
+			if (!equal)
+				isl_die(ctx, isl_error_unknown,
+					"unexpected optimal value",
+					return isl_stat_error);
+		}
+		isl_aff_free(obj);
+	}
+
+	return isl_stat_ok;
+}
+
+/* Constraints that are successively added in test_lp_solver.
+ * The last one makes the set empty.
+ */
+static const char *lp_solver_con[] = {
+	"{ [x, y, z] : x + 2y >= 5 }",
+	"{ [x, y, z] : x - z = 3 }",
+	"{ [x, y, z] : 3y <= 2z + 1 }",
+	"{ [x, y, z] : x >= 11 }",
+};
+
+/* Check that an isl_lp_solver produces the same results
+ * as isl_basic_set_min_lp_val and isl_basic_set_max_lp_val,
+ * both while constraints are being added and while they are being
+ * removed again.
+ * bset[i] is the basic set with the first i constraints
+ * from lp_solver_con added.
+ */
+static int test_lp_solver(isl_ctx *ctx)
+{
+	int i, n = ARRAY_SIZE(lp_solver_con);
+	isl_basic_set *bset[ARRAY_SIZE(lp_solver_con) + 1];
+	isl_lp_solver *solver;
+
+	bset[0] = isl_basic_set_read_from_str(ctx, "{ [x, y, z] : "
+		"0 <= x <= 10 and 0 <= y <= 10 and 0 <= z <= 10 and "
+		"x + y + z <= 20 }");
+	solver = isl_lp_solver_from_basic_set(isl_basic_set_copy(bset[0]));
+	for (i = 0; i < n; ++i) {
+		isl_basic_set *c;
+		isl_constraint_list *list;
+
+		if (check_lp_solver(solver, bset[i]) < 0)
+			break;
+		c = isl_basic_set_read_from_str(ctx, lp_solver_con[i]);
+		list = isl_basic_set_get_constraint_list(c);
+		solver = isl_lp_solver_add_constraint(solver,
+				isl_constraint_list_get_at(list, 0));
+		isl_constraint_list_free(list);
+		bset[i + 1] = isl_basic_set_intersect(
+				isl_basic_set_copy(bset[i]), c);
+	}
+	if (i < n) {
+		for (; i >= 0; --i)
+			isl_basic_set_free(bset[i]);
+		isl_lp_solver_free(solver);
+		return -1;
+	}
+	for (i = n; i >= 0; --i) {
+		if (check_lp_solver(solver, bset[i]) < 0)
+			break;
+		isl_basic_set_free(bset[i]);
+		if (i > 0)
+			solver = isl_lp_solver_drop_last_constraint(solver);
+	}
+	if (i >= 0) {
+		for (; i >= 0; --i)
+			isl_basic_set_free(bset[i]);
+		isl_lp_solver_free(solver);
+		return -1;
+	}
+
+	isl_lp_solver_free(solver);
+	return 0;
+}
+
+/* Basic sets that are checked for emptiness in test_list_empty.
+ */
+static const char *list_empty_tests[] = {
+	"{ [x, y] : 0 <= x <= 10 and 0 <= y <= 10 }",
+	"{ [x, y] : 0 <= x <= 5 and 0 <= y <= x }",
+	"{ [x, y] : 2x = 1 and 0 <= y <= 10 }",
+	"{ [x, y] : 0 <= x <= 5 and 3 <= y <= x }",
+	"{ [x, y] : x >= 10 and y >= 10 and x + y <= 19 }",
+	"{ [x, y] : exists (e : x = 2e) and 0 <= x <= 1 and y = 3 }",
+	"{ [x, y] : 0 <= x <= 5 and 0 <= y <= 5 }",
+	"{ [x, y] : 3 <= 3x <= 4 and 0 <= y <= 5 }",
+	"{ [x, y] : y = 3 and 1 <= x <= 2 }",
+};
+
+/* Check that isl_basic_set_list_each_is_empty produces
+ * the same results as isl_basic_set_is_empty.
+ */
+static int test_list_empty(isl_ctx *ctx)
+{
+	int i, n = ARRAY_SIZE(list_empty_tests);
+	isl_bool empty[ARRAY_SIZE(list_empty_tests)];
+	isl_basic_set_list *list;
+	isl_stat r;
+
+	list = isl_basic_set_list_alloc(ctx, n);
+	for (i = 0; i < n; ++i) {
+		isl_basic_set *bset;
+
+		bset = isl_basic_set_read_from_str(ctx, list_empty_tests[i]);
+		list = isl_basic_set_list_add(list, bset);
+	}
+	r = isl_basic_set_list_each_is_empty(list, empty);
+	for (i = 0; r >= 0 && i < n; ++i) {
+		isl_basic_set *bset;
+		isl_bool expected;
+
+		bset = isl_basic_set_read_from_str(ctx, list_empty_tests[i]);
+		expected = isl_basic_set_is_empty(bset);
+		isl_basic_set_free(bset);
+		if (expected < 0)
+			r = isl_stat_error;
+		else if (empty[i] != expected)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected emptiness", r = isl_stat_error);
+	}
+	isl_basic_set_list_free(list);
+
+	return r < 0 ? -1 : 0;
+}
+
+/* Inputs for isl_basic_map_drop_redundant_by_bounds tests,
+ * along with the number of constraints of the result and
+ * whether the result is expected to be marked empty.
+ */
+struct {
+	const char *set;
+	int n_constraint;
+	int empty;
+} drop_by_bounds_tests[] = {
+	{ "{ [x, y] : 0 <= x <= 3 and 0 <= y <= 3 and x + y <= 10 }", 4, 0 },
+	{ "{ [x, y] : 0 <= x <= 3 and 0 <= y <= 3 and x + y <= 5 }", 5, 0 },
+	{ "{ [x, y] : 0 <= x <= 3 and 0 <= y and 2y <= 7 and "
+		"x - y >= -4 and 2x - 2y <= 7 }", 4, 0 },
+	{ "{ [x, y] : 0 <= x <= 3 and 0 <= y <= 3 and x + y >= 7 }", 0, 1 },
+	{ "{ [x, y] : 0 <= x <= 3 and 5 <= x and 0 <= y <= 3 }", 0, 1 },
+	{ "{ [x, y] : 0 <= x <= 3 and x + y >= 0 }", 3, 0 },
+};
+
+/* Check that isl_basic_map_drop_redundant_by_bounds
+ * drops the expected number of constraints or detects
+ * the expected emptiness without changing the set.
+ */
+static int test_drop_redundant_by_bounds(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(drop_by_bounds_tests); ++i) {
+		const char *str = drop_by_bounds_tests[i].set;
+		isl_basic_set *bset, *res;
+		isl_bool equal, empty;
+		isl_size n;
+
+		bset = isl_basic_set_read_from_str(ctx, str);
+		res = isl_basic_set_copy(bset);
+		res = bset_from_bmap(isl_basic_map_drop_redundant_by_bounds(
+							bset_to_bmap(res)));
+		n = isl_basic_set_n_constraint(res);
+		empty = isl_basic_set_plain_is_empty(res);
+		equal = isl_basic_set_is_equal(bset, res);
+		isl_basic_set_free(bset);
+		isl_basic_set_free(res);
+		if (n < 0 || empty < 0 || equal < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"set changed", return -1);
+		if (empty != drop_by_bounds_tests[i].empty)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected emptiness", return -1);
+		if (!empty && n != drop_by_bounds_tests[i].n_constraint)
+			isl_die(ctx, isl_error_unknown,
+				"unexpected number of constraints", return -1);
+	}
+
+	return 0;
+}
+
+/* Check that the statistics on coalescing and Farkas constructions
+ * are updated and that they are reported in the JSON representation,
+ * along with the other statistics.
+ * The processor time should not be measured
+ * if the stats_clock option is not set.
+ * Also check that all statistics can be queried individually.
+ */
+static int test_stats(isl_ctx *ctx)
+{
+	enum isl_ctx_stat stat;
+	isl_set *set;
+	isl_basic_set *bset;
+	char *json;
+	int ok;
+
+	isl_ctx_reset_stats(ctx);
+	set = isl_set_read_from_str(ctx,
+		"{ [x] : 0 <= x <= 10 or 11 <= x <= 20 }");
+	set = isl_set_coalesce(set);
+	isl_set_free(set);
+	bset = isl_basic_set_read_from_str(ctx, "{ [x, y] : 0 <= x <= y }");
+	bset = isl_basic_set_coefficients(bset);
+	isl_basic_set_free(bset);
+	if (!set || !bset)
+		return -1;
+	for (stat = isl_ctx_stat_gbr_solved_lps;
+	    stat <= isl_ctx_stat_ast_build_clock; ++stat)
+		if (isl_ctx_get_stat(ctx, stat) < 0)
+			return -1;
+	if (isl_ctx_get_stat(ctx, isl_ctx_stat_coalesce_pairs) == 0 ||
+	    isl_ctx_get_stat(ctx, isl_ctx_stat_farkas) != 1 ||
+	    isl_ctx_get_stat(ctx, isl_ctx_stat_tab_alloc) == 0)
+		isl_die(ctx, isl_error_unknown,
+			"statistics not updated", return -1);
+	if (!isl_options_get_stats_clock(ctx) &&
+	    (isl_ctx_get_stat(ctx, isl_ctx_stat_coalesce_clock) != 0 ||
+	     isl_ctx_get_stat(ctx, isl_ctx_stat_farkas_clock) != 0))
+		isl_die(ctx, isl_error_unknown,
+			"processor time unexpectedly measured", return -1);
+	json = isl_ctx_stats_to_json(ctx);
+	if (!json)
+		return -1;
+	ok = strncmp(json, "{ \"operations\": ", 16) == 0 &&
+	    strstr(json, "\"farkas\": 1,") &&
+	    strstr(json, "\"farkas_clock\": ") &&
+	    strstr(json, "\"gbr_solved_lps\": ") &&
+	    strstr(json, "\"pip_splits\": ");
+	free(json);
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected JSON statistics", return -1);
+
+	return 0;
+}
+
+/* Internal data structure for test_trace.
+ *
+ * "depth" is the current nesting depth of the spans.
+ * "n_schedule" is the number of completed scheduling spans.
+ * "error" is set if an unbalanced end event is encountered.
+ * "freed" is set when the user data is freed.
+ */
+struct isl_test_trace_data {
+	int depth;
+	int n_schedule;
+	int error;
+	int freed;
+};
+
+/* Keep track of the nesting of the spans reported by the trace callback.
+ */
+static void trace_count(isl_ctx *ctx, enum isl_trace_event event,
+	const char *name, int size, void *user)
+{
+	struct isl_test_trace_data *data = user;
+
+	if (event == isl_trace_begin) {
+		data->depth++;
+		return;
+	}
+	if (data->depth <= 0)
+		data->error = 1;
+	data->depth--;
+	if (!strcmp(name, "isl_schedule_constraints_compute_schedule"))
+		data->n_schedule++;
+}
+
+/* Record that the user data of the trace callback has been freed.
+ */
+static void trace_free(void *user)
+{
+	struct isl_test_trace_data *data = user;
+
+	data->freed = 1;
+}
+
+/* Compute a schedule for a simple dependence graph.
+ */
+static isl_stat trace_schedule(isl_ctx *ctx)
+{
+	isl_union_set *domain;
+	isl_union_map *dep;
+	isl_schedule_constraints *sc;
+	isl_schedule *schedule;
+
+	domain = isl_union_set_read_from_str(ctx,
+		"{ A[i] : 0 <= i < 10; B[i] : 0 <= i < 10 }");
+	dep = isl_union_map_read_from_str(ctx, "{ A[i] -> B[i] }");
+	sc = isl_schedule_constraints_on_domain(domain);
+	sc = isl_schedule_constraints_set_validity(sc, dep);
+	schedule = isl_schedule_constraints_compute_schedule(sc);
+	isl_schedule_free(schedule);
+
+	return schedule ? isl_stat_ok : isl_stat_error;
+}
+
+/* Check that the trace callback reports properly nested spans
+ * and that the Chrome trace writer produces a JSON array.
+ */
+static int test_trace(isl_ctx *ctx)
+{
+	struct isl_test_trace_data data = { 0 };
+	FILE *out;
+	char buf[32];
+	size_t len;
+	int ok;
+
+	if (isl_ctx_set_trace_callback(ctx, &trace_count, &data,
+					&trace_free) < 0)
+		return -1;
+	if (trace_schedule(ctx) < 0)
+		return -1;
+	if (isl_ctx_set_trace_callback(ctx, NULL, NULL, NULL) < 0)
+		return -1;
+	if (data.error || data.depth != 0 || data.n_schedule != 1 ||
+	    !data.freed)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected trace events", return -1);
+
+	out = tmpfile();
+	if (!out)
+		isl_die(ctx, isl_error_unknown, "unable to open file",
+			return -1);
+	if (isl_ctx_trace_to_chrome_file(ctx, out) < 0 ||
+	    trace_schedule(ctx) < 0 ||
+	    isl_ctx_set_trace_callback(ctx, NULL, NULL, NULL) < 0) {
+		fclose(out);
+		return -1;
+	}
+	rewind(out);
+	len = fread(buf, 1, sizeof(buf) - 1, out);
+	buf[len] = '\0';
+	ok = strncmp(buf, "[\n{ \"name\": \"isl_schedule_constraints_", 30)
+		== 0;
+	fseek(out, -3, SEEK_END);
+	len = fread(buf, 1, 3, out);
+	buf[len] = '\0';
+	ok = ok && strcmp(buf, "\n]\n") == 0;
+	fclose(out);
+	if (!ok)
+		isl_die(ctx, isl_error_unknown,
+			"unexpected Chrome trace", return -1);
+
+	return 0;
+}
+
 struct {
 	const char *name;
 	int (*fn)(isl_ctx *ctx);
@@ -10730,6 +12096,9 @@ struct {
 	{ "injective", &test_injective },
 	{ "schedule (whole component)", &test_schedule_whole },
 	{ "schedule (incremental)", &test_schedule_incremental },
+	{ "schedule update", &test_schedule_update },
+	{ "schedule cache", &test_schedule_cache },
+	{ "schedule budget", &test_schedule_budget },
 	{ "schedule tree", &test_schedule_tree },
 	{ "schedule tree prefix", &test_schedule_tree_prefix },
 	{ "schedule tree grouping", &test_schedule_tree_group },
@@ -10749,6 +12118,7 @@ struct {
 	{ "subtract", &test_subtract },
 	{ "intersect", &test_intersect },
 	{ "lexmin", &test_lexmin },
+	{ "parametric integer programming statistics", &test_pip_stats },
 	{ "min", &test_min },
 	{ "set lower bounds", &test_min_mpa },
 	{ "gist", &test_gist },
@@ -10771,6 +12141,17 @@ struct {
 	{ "convex hull", &test_convex_hull },
 	{ "transitive closure", &test_closure },
 	{ "isl_bool", &test_isl_bool},
+	{ "child contexts", &test_ctx_child },
+	{ "block cache", &test_blk_cache },
+	{ "block retention", &test_block_retention },
+	{ "subtract pruning", &test_subtract_pruning },
+	{ "basic map cache", &test_basic_map_cache },
+	{ "floating point guided simplex", &test_tab_float_guide },
+	{ "warm-started LP solver", &test_lp_solver },
+	{ "emptiness of lists of basic sets", &test_list_empty },
+	{ "redundancy removal by bounds", &test_drop_redundant_by_bounds },
+	{ "statistics", &test_stats },
+	{ "tracing", &test_trace },
 };
 
 int main(int argc, char **argv)
@@ -57,6 +57,10 @@ struct {
 	{ &int_test_hash, "-2147483647" },
 	{ &int_test_hash, "2147483648" },
 	{ &int_test_hash, "-2147483648" },
+	{ &int_test_hash, "4611686018427387903" },
+	{ &int_test_hash, "-4611686018427387903" },
+	{ &int_test_hash, "4611686018427387904" },
+	{ &int_test_hash, "-4611686018427387904" },
 };
 
 static void int_test_single_value()
@@ -504,6 +508,11 @@ struct {
 	{ &int_test_sum, "2147483648", "2147483647", "1" },
 	{ &int_test_sum, "-2147483648", "-2147483647", "-1" },
 
+	{ &int_test_sum, "4611686018427387904", "4611686018427387903", "1" },
+	{ &int_test_sum, "-4611686018427387904", "-4611686018427387903", "-1" },
+	{ &int_test_sum, "9223372036854775806",
+	  "4611686018427387903", "4611686018427387903" },
+
 	{ &int_test_product, "0", "0", "0" },
 	{ &int_test_product, "0", "0", "1" },
 	{ &int_test_product, "1", "1", "1" },
@@ -530,6 +539,19 @@ struct {
 	{ &int_test_product,
 	  "4611686016279904256", "-2147483647", "-2147483648" },
 
+	{ &int_test_product,
+	  "9223372036854775806", "4611686018427387903", "2" },
+	{ &int_test_product,
+	  "-9223372036854775806", "4611686018427387903", "-2" },
+	{ &int_test_product,
+	  "9223372030926249001", "3037000499", "3037000499" },
+	{ &int_test_product,
+	  "9223372037000250000", "3037000500", "3037000500" },
+	{ &int_test_product,
+	  "-9223372037000250000", "-3037000500", "3037000500" },
+	{ &int_test_product,
+	  "13835058055282163709", "4611686018427387903", "3" },
+
 	{ &int_test_product, "85070591730234615847396907784232501249",
 	  "9223372036854775807", "9223372036854775807" },
 	{ &int_test_product, "-85070591730234615847396907784232501249",
@@ -577,6 +599,9 @@ struct {
 	{ &int_test_cdiv, "-1073741824", "-2147483648", "2" },
 	{ &int_test_cdiv, "-1073741823", "-2147483647", "2" },
 
+	{ &int_test_cdiv, "2305843009213693952", "4611686018427387903", "2" },
+	{ &int_test_fdiv, "-2305843009213693952", "-4611686018427387903", "2" },
+
 	{ &int_test_tdiv, "0", "1", "2" },
 	{ &int_test_tdiv, "0", "-1", "2" },
 	{ &int_test_tdiv, "0", "1", "-2" },
@@ -602,6 +627,8 @@ struct {
 	{ &int_test_lcm, "55340232221128654842", "6", "9223372036854775807" },
 	{ &int_test_gcd, "2", "6", "-9223372036854775808" },
 	{ &int_test_lcm, "27670116110564327424", "6", "-9223372036854775808" },
+	{ &int_test_gcd, "3", "6", "4611686018427387903" },
+	{ &int_test_lcm, "9223372036854775806", "6", "4611686018427387903" },
 	{ &int_test_gcd, "1", "18446744073709551616", "18446744073709551615" },
 	{ &int_test_lcm, "340282366920938463444927863358058659840",
 	  "18446744073709551616", "18446744073709551615" },
@@ -499,6 +499,12 @@ struct isl_hash_table_entry *isl_union_set_find_entry(
 	return isl_union_map_find_entry(uset_to_umap(uset), space, reserve);
 }
 
+/* Add "map" to "umap".
+ *
+ * If spaces are being interned, then the space of "map"
+ * is replaced by its canonical copy such that maps with identical spaces
+ * in different union maps share the same space object.
+ */
 __isl_give isl_union_map *isl_union_map_add_map(__isl_take isl_union_map *umap,
 	__isl_take isl_map *map)
 {
@@ -523,6 +529,7 @@ __isl_give isl_union_map *isl_union_map_add_map(__isl_take isl_union_map *umap,
 	}
 
 	umap = isl_union_map_cow(umap);
+	map = isl_map_intern_space(map);
 
 	space = isl_map_peek_space(map);
 	entry = isl_union_map_find_entry(umap, space, 1);
@@ -1606,13 +1613,136 @@ __isl_give isl_union_map *isl_union_map_intersect_range_factor_range(
 	return gen_bin_op(umap, factor, &control);
 }
 
+/* Internal data structure for bin_op and tuple_bin_op.
+ *
+ * "umap2" is the second argument of the operation and
+ * "res" collects the results.
+ * "map" is the map in the first argument that is currently being handled.
+ * "fn" is called on each map in "umap2" that is paired with "map".
+ *
+ * If "index" is not NULL, then only the maps in "umap2"
+ * with a "type2" tuple that is equal to the "type1" tuple of "map"
+ * are paired with "map".  "index" then groups the maps in "umap2"
+ * by their "type2" tuple.  Each entry is a list of maps
+ * in the order in which they appear in "umap2".
+ * Otherwise, "map" is paired with every map in "umap2".
+ */
 struct isl_union_map_bin_data {
 	isl_union_map *umap2;
+	struct isl_hash_table *index;
+	enum isl_dim_type type1;
+	enum isl_dim_type type2;
 	isl_union_map *res;
 	isl_map *map;
 	isl_stat (*fn)(void **entry, void *user);
 };
 
+/* Return the hash value of the "type" tuple of "map",
+ * with "type" either isl_dim_in or isl_dim_out.
+ */
+static uint32_t map_tuple_hash(__isl_keep isl_map *map,
+	enum isl_dim_type type)
+{
+	isl_space *space;
+
+	space = isl_map_peek_space(map);
+	if (type == isl_dim_in)
+		return isl_space_get_tuple_domain_hash(space);
+	return isl_space_get_tuple_range_hash(space);
+}
+
+/* A map and one of its tuples, used for lookups in
+ * the "index" of an isl_union_map_bin_data.
+ * "type" refers to the tuple of "map" and
+ * "list_type" to the tuple of the maps in the index.
+ */
+struct isl_union_map_tuple_key {
+	isl_map *map;
+	enum isl_dim_type type;
+	enum isl_dim_type list_type;
+};
+
+/* Does the list of maps "entry" consist of maps with
+ * a tuple that is equal to the tuple of the map in the key "val"?
+ * Since the maps in the list all have the same tuple,
+ * it is sufficient to check the first one.
+ */
+static isl_bool has_same_tuple(const void *entry, const void *val)
+{
+	isl_map_list *list = (isl_map_list *) entry;
+	const struct isl_union_map_tuple_key *key = val;
+	isl_map *map;
+
+	map = list->p[0];
+	return isl_map_tuple_is_equal(map, key->list_type,
+					key->map, key->type);
+}
+
+/* Add the map stored at "entry" to the index in "user",
+ * grouping it with the other maps with the same tuple.
+ */
+static isl_stat index_entry(void **entry, void *user)
+{
+	struct isl_union_map_bin_data *data = user;
+	struct isl_union_map_tuple_key key = { *entry, data->type2,
+						data->type2 };
+	struct isl_hash_table_entry *index_entry;
+	isl_ctx *ctx = isl_union_map_get_ctx(data->umap2);
+	isl_map *map = *entry;
+
+	index_entry = isl_hash_table_find(ctx, data->index,
+				map_tuple_hash(map, data->type2),
+				&has_same_tuple, &key, 1);
+	if (!index_entry)
+		return isl_stat_error;
+	if (!index_entry->data)
+		index_entry->data = isl_map_list_alloc(ctx, 1);
+	index_entry->data = isl_map_list_add(index_entry->data,
+						isl_map_copy(map));
+	if (!index_entry->data)
+		return isl_stat_error;
+
+	return isl_stat_ok;
+}
+
+/* Free the list of maps stored at "entry".
+ */
+static isl_stat free_index_entry(void **entry, void *user)
+{
+	isl_map_list_free(*entry);
+	return isl_stat_ok;
+}
+
+/* Free the index in "data", if any.
+ */
+static void free_index(struct isl_union_map_bin_data *data)
+{
+	isl_ctx *ctx;
+
+	if (!data->index)
+		return;
+	ctx = isl_union_map_get_ctx(data->umap2);
+	isl_hash_table_foreach(ctx, data->index, &free_index_entry, NULL);
+	isl_hash_table_free(ctx, data->index);
+	data->index = NULL;
+}
+
+/* Construct an index of the maps in data->umap2 by their data->type2 tuple.
+ */
+static isl_stat build_index(struct isl_union_map_bin_data *data)
+{
+	isl_ctx *ctx;
+
+	ctx = isl_union_map_get_ctx(data->umap2);
+	data->index = isl_hash_table_alloc(ctx, data->umap2->table.n);
+	if (!data->index)
+		return isl_stat_error;
+	if (isl_hash_table_foreach(ctx, &data->umap2->table,
+				    &index_entry, data) < 0)
+		return isl_stat_error;
+	return isl_stat_ok;
+}
+
 static isl_stat apply_range_entry(void **entry, void *user)
 {
 	struct isl_union_map_bin_data *data = user;
@@ -1643,48 +1773,127 @@ static isl_stat apply_range_entry(void **entry, void *user)
 	return isl_stat_ok;
 }
 
+/* Call data->fn on "map" from the index in "user".
+ */
+static isl_stat call_on_indexed(__isl_take isl_map *map, void *user)
+{
+	struct isl_union_map_bin_data *data = user;
+	void *entry = map;
+	isl_stat r;
+
+	r = data->fn(&entry, data);
+	isl_map_free(map);
+
+	return r;
+}
+
+/* Call data->fn on each map in data->umap2 that should be paired
+ * with data->map.  If there is an index, then only the maps
+ * in the group with a matching tuple need to be considered.
+ */
 static isl_stat bin_entry(void **entry, void *user)
 {
 	struct isl_union_map_bin_data *data = user;
+	struct isl_hash_table_entry *index_entry;
+	struct isl_union_map_tuple_key key;
+	isl_ctx *ctx = data->umap2->dim->ctx;
 	isl_map *map = *entry;
 
 	data->map = map;
-	if (isl_hash_table_foreach(data->umap2->dim->ctx, &data->umap2->table,
-				   data->fn, data) < 0)
+	if (!data->index)
+		return isl_hash_table_foreach(ctx, &data->umap2->table,
+						data->fn, data);
+
+	key.map = map;
+	key.type = data->type1;
+	key.list_type = data->type2;
+	index_entry = isl_hash_table_find(ctx, data->index,
+				map_tuple_hash(map, data->type1),
+				&has_same_tuple, &key, 0);
+	if (!index_entry)
 		return isl_stat_error;
-
-	return isl_stat_ok;
+	if (index_entry == isl_hash_table_entry_none)
+		return isl_stat_ok;
+	return isl_map_list_foreach(index_entry->data,
+					&call_on_indexed, data);
 }
 
-static __isl_give isl_union_map *bin_op(__isl_take isl_union_map *umap1,
-	__isl_take isl_union_map *umap2,
-	isl_stat (*fn)(void **entry, void *user))
+/* Call data->fn on pairs of maps from "umap1" and "umap2" and
+ * collect the results.
+ * If "indexed" is set, then only the pairs with
+ * a matching data->type1 tuple in the map from "umap1" and
+ * data->type2 tuple in the map from "umap2" are considered.
+ */
+static __isl_give isl_union_map *bin_op_data(__isl_take isl_union_map *umap1,
+	__isl_take isl_union_map *umap2, struct isl_union_map_bin_data *data,
+	int indexed)
 {
-	struct isl_union_map_bin_data data = { NULL, NULL, NULL, fn };
-
 	umap1 = isl_union_map_align_params(umap1, isl_union_map_get_space(umap2));
 	umap2 = isl_union_map_align_params(umap2, isl_union_map_get_space(umap1));
 
 	if (!umap1 || !umap2)
 		goto error;
 
-	data.umap2 = umap2;
-	data.res = isl_union_map_alloc(isl_space_copy(umap1->dim),
+	data->umap2 = umap2;
+	if (indexed && build_index(data) < 0)
+		goto error;
+	data->res = isl_union_map_alloc(isl_space_copy(umap1->dim),
 				       umap1->table.n);
 	if (isl_hash_table_foreach(umap1->dim->ctx, &umap1->table,
-				   &bin_entry, &data) < 0)
+				   &bin_entry, data) < 0)
 		goto error;
 
+	free_index(data);
 	isl_union_map_free(umap1);
 	isl_union_map_free(umap2);
-	return data.res;
+	return data->res;
 error:
+	free_index(data);
 	isl_union_map_free(umap1);
 	isl_union_map_free(umap2);
-	isl_union_map_free(data.res);
+	isl_union_map_free(data->res);
 	return NULL;
 }
 
+/* Call "fn" on each pair of maps from "umap1" and "umap2" and
+ * collect the results.
+ */
+static __isl_give isl_union_map *bin_op(__isl_take isl_union_map *umap1,
+	__isl_take isl_union_map *umap2,
+	isl_stat (*fn)(void **entry, void *user))
+{
+	struct isl_union_map_bin_data data = { NULL, NULL };
+
+	data.fn = fn;
+	return bin_op_data(umap1, umap2, &data, 0);
+}
+
+/* Call "fn" on each pair of maps from "umap1" and "umap2"
+ * where the "type1" tuple of the map from "umap1" is equal
+ * to the "type2" tuple of the map from "umap2" and
+ * collect the results.
+ *
+ * Rather than considering all pairs of maps, group the maps
+ * in "umap2" by their "type2" tuple such that only the maps
+ * with a matching tuple are considered for each map in "umap1".
+ * "fn" still needs to check that the tuples match since
+ * it may also be called on maps with the same hash value.
+ * Since each group keeps the order of the maps in "umap2",
+ * "fn" is called on the pairs in the same order as in bin_op.
+ */
+static __isl_give isl_union_map *tuple_bin_op(__isl_take isl_union_map *umap1,
+	__isl_take isl_union_map *umap2,
+	enum isl_dim_type type1, enum isl_dim_type type2,
+	isl_stat (*fn)(void **entry, void *user))
+{
+	struct isl_union_map_bin_data data = { NULL, NULL };
+
+	data.type1 = type1;
+	data.type2 = type2;
+	data.fn = fn;
+	return bin_op_data(umap1, umap2, &data, 1);
+}
+
 /* Intersect each map in "umap" in a space [A -> B] -> C
  * with the corresponding set in "domain" in the space A and
  * collect the results.
@@ -1722,7 +1931,8 @@ isl_union_map_intersect_range_wrapped_domain_union_set(
 __isl_give isl_union_map *isl_union_map_apply_range(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &apply_range_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_out, isl_dim_in,
+				&apply_range_entry);
 }
 
 __isl_give isl_union_map *isl_union_map_apply_domain(
@@ -1762,7 +1972,8 @@ static isl_stat map_lex_lt_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_lex_lt_union_map(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &map_lex_lt_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_out, isl_dim_out,
+				&map_lex_lt_entry);
 }
 
 static isl_stat map_lex_le_entry(void **entry, void *user)
@@ -1788,7 +1999,8 @@ static isl_stat map_lex_le_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_lex_le_union_map(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &map_lex_le_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_out, isl_dim_out,
+				&map_lex_le_entry);
 }
 
 static isl_stat product_entry(void **entry, void *user)
@@ -1853,7 +2065,8 @@ static isl_stat domain_product_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_domain_product(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &domain_product_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_out, isl_dim_out,
+				&domain_product_entry);
 }
 
 static isl_stat range_product_entry(void **entry, void *user)
@@ -1879,7 +2092,8 @@ static isl_stat range_product_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_range_product(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &range_product_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_in, isl_dim_in,
+				&range_product_entry);
 }
 
 /* If data->map A -> B and "map2" C -> D have the same range space,
@@ -1911,7 +2125,8 @@ static isl_stat flat_domain_product_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_flat_domain_product(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &flat_domain_product_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_out, isl_dim_out,
+				&flat_domain_product_entry);
 }
 
 static isl_stat flat_range_product_entry(void **entry, void *user)
@@ -1937,7 +2152,8 @@ static isl_stat flat_range_product_entry(void **entry, void *user)
 __isl_give isl_union_map *isl_union_map_flat_range_product(
 	__isl_take isl_union_map *umap1, __isl_take isl_union_map *umap2)
 {
-	return bin_op(umap1, umap2, &flat_range_product_entry);
+	return tuple_bin_op(umap1, umap2, isl_dim_in, isl_dim_in,
+				&flat_range_product_entry);
 }
 
 /* Data structure that specifies how un_op should modify